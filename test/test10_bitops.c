@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "../vectorize.h"
+
+#define NWORDS 1000
+
+static uint32_t ref_rotl(uint32_t x, int k) { return k ? (x << k) | (x >> (32 - k)) : x; }
+static int ref_popcnt(uint32_t x) { int c = 0; for (; x; x &= x - 1) c++; return c; }
+static int ref_lzcnt(uint32_t x) { int c = 0; if (!x) return 32; while (!(x & 0x80000000u)) { x <<= 1; c++; } return c; }
+static uint64_t ref_popcnt64(uint64_t x) { uint64_t c = 0; for (; x; x &= x - 1) c++; return c; }
+
+static uint32_t rand32(void) { return ((uint32_t)rand() << 16) ^ (uint32_t)rand() ^ ((uint32_t)rand() << 30); }
+
+int main() {
+    int32_t x[16], k[16], r[16];
+    uint64_t* a = (uint64_t*)malloc(NWORDS * sizeof(uint64_t));
+    uint64_t* b = (uint64_t*)malloc(NWORDS * sizeof(uint64_t));
+    uint64_t* d = (uint64_t*)malloc(NWORDS * sizeof(uint64_t));
+    int errors = 0;
+
+    srand(3);
+    for (int iter = 0; iter < 2000; iter++) {
+        for (int i = 0; i < 16; i++) {
+            uint32_t v = rand32();
+            if (iter == 0) v = (i == 0) ? 0u : (i == 1) ? 0xFFFFFFFFu : (i == 2) ? 0x80000000u : (uint32_t)1 << i;
+            if (iter == 1) v = 0xFFFFFFFFu >> i;
+            x[i] = (int32_t)v;
+            k[i] = rand() % 33;
+        }
+        vint_t vx = VEC_LOADU_I(x), vk = VEC_LOADU_I(k);
+
+        VEC_STOREU_I(r, VEC_SLL_I(vx, 7));
+        for (int i = 0; i < VEC_WIDTH; i++) errors += (uint32_t)r[i] != (uint32_t)x[i] << 7;
+        VEC_STOREU_I(r, VEC_SRL_I(vx, 13));
+        for (int i = 0; i < VEC_WIDTH; i++) errors += (uint32_t)r[i] != (uint32_t)x[i] >> 13;
+        VEC_STOREU_I(r, VEC_SRA_I(vx, 31));
+        for (int i = 0; i < VEC_WIDTH; i++) errors += r[i] != (x[i] < 0 ? -1 : 0);
+        VEC_STOREU_I(r, VEC_ROTL_I(vx, 11));
+        for (int i = 0; i < VEC_WIDTH; i++) errors += (uint32_t)r[i] != ref_rotl((uint32_t)x[i], 11);
+
+        VEC_STOREU_I(r, VEC_SLLV_I(vx, vk));
+        for (int i = 0; i < VEC_WIDTH; i++) errors += (uint32_t)r[i] != (k[i] >= 32 ? 0u : (uint32_t)x[i] << k[i]);
+        VEC_STOREU_I(r, VEC_SRLV_I(vx, vk));
+        for (int i = 0; i < VEC_WIDTH; i++) errors += (uint32_t)r[i] != (k[i] >= 32 ? 0u : (uint32_t)x[i] >> k[i]);
+        VEC_STOREU_I(r, VEC_SRAV_I(vx, vk));
+        for (int i = 0; i < VEC_WIDTH; i++) errors += r[i] != (x[i] >> (k[i] >= 32 ? 31 : k[i]));
+        for (int i = 0; i < 16; i++) k[i] &= 31;
+        vk = VEC_LOADU_I(k);
+        VEC_STOREU_I(r, VEC_ROTLV_I(vx, vk));
+        for (int i = 0; i < VEC_WIDTH; i++) errors += (uint32_t)r[i] != ref_rotl((uint32_t)x[i], k[i]);
+
+        VEC_STOREU_I(r, VEC_POPCNT_I(vx));
+        for (int i = 0; i < VEC_WIDTH; i++) errors += r[i] != ref_popcnt((uint32_t)x[i]);
+        VEC_STOREU_I(r, VEC_LZCNT_I(vx));
+        for (int i = 0; i < VEC_WIDTH; i++) errors += r[i] != ref_lzcnt((uint32_t)x[i]);
+    }
+    printf("Vector width: %d\n", VEC_WIDTH);
+    printf("Lane op mismatches: %d\n", errors);
+
+    /* 位图：不同长度（含尾部）与 dst 为 NULL / 原地 */
+    errors = 0;
+    for (size_t i = 0; i < NWORDS; i++) {
+        a[i] = ((uint64_t)rand32() << 32) | rand32();
+        b[i] = ((uint64_t)rand32() << 32) | rand32();
+    }
+    for (size_t n = 0; n <= NWORDS; n += 37) {
+        uint64_t ref_a = 0, ref_and = 0, ref_or = 0, ref_andnot = 0;
+        for (size_t i = 0; i < n; i++) {
+            ref_a += ref_popcnt64(a[i]);
+            ref_and += ref_popcnt64(a[i] & b[i]);
+            ref_or += ref_popcnt64(a[i] | b[i]);
+            ref_andnot += ref_popcnt64(a[i] & ~b[i]);
+        }
+        errors += vec_bitmap_popcount(a, n) != ref_a;
+        errors += vec_bitmap_and(NULL, a, b, n) != ref_and;
+        errors += vec_bitmap_or(d, a, b, n) != ref_or;
+        for (size_t i = 0; i < n; i++) errors += d[i] != (a[i] | b[i]);
+        errors += vec_bitmap_andnot(d, a, b, n) != ref_andnot;
+        for (size_t i = 0; i < n; i++) errors += d[i] != (a[i] & ~b[i]);
+        errors += vec_bitmap_and(d, d, b, n) != 0;  /* (a & ~b) & b == 0，原地 */
+    }
+    printf("popcount(a) over %d words: %llu\n", NWORDS, (unsigned long long)vec_bitmap_popcount(a, NWORDS));
+    printf("Bitmap mismatches: %d\n", errors);
+
+    free(a);
+    free(b);
+    free(d);
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "../vectorize.h"
+
+#define ROWS 7
+#define CH 131
+#define N (ROWS * CH)
+
+/* 参考实现：round-half-even + 饱和 */
+static int32_t ref_q(float x, float scale, int32_t zp, int32_t lo, int32_t hi) {
+    double q = (double)lrintf(x * (1.0f / scale)) + zp;
+    return q < lo ? lo : (q > hi ? hi : (int32_t)q);
+}
+
+int main() {
+    float* x = (float*)malloc(N * sizeof(float));
+    float* y = (float*)malloc(N * sizeof(float));
+    int8_t* qi = (int8_t*)malloc(N);
+    uint8_t* qu = (uint8_t*)malloc(N);
+    int8_t* wb = (int8_t*)malloc(N);
+    float scale[CH];
+    int32_t zp[CH];
+    int errors = 0;
+    double max_err = 0.0;
+
+    srand(11);
+    for (size_t i = 0; i < N; i++) x[i] = ((float)rand() / RAND_MAX - 0.5f) * 8.0f;
+    x[5] = 1e9f;       /* 饱和 */
+    x[6] = -1e9f;
+    x[7] = 0.25f;      /* 0.25 / 0.1 = 2.5 -> 2（最近偶数） */
+    for (size_t c = 0; c < CH; c++) {
+        scale[c] = 0.01f + 0.05f * (float)(c % 5);
+        zp[c] = (int32_t)(c % 7) - 3;
+    }
+
+    /* 每张量：i8 与 u8，覆盖不同长度（含尾部） */
+    for (size_t n = 0; n <= N; n += 53) {
+        vec_quantize_f32_to_i8(qi, x, n, 0.1f, 3);
+        vec_quantize_f32_to_u8(qu, x, n, 0.1f, 128);
+        for (size_t i = 0; i < n; i++) {
+            errors += qi[i] != ref_q(x[i], 0.1f, 3, -128, 127);
+            errors += qu[i] != ref_q(x[i], 0.1f, 128, 0, 255);
+        }
+    }
+    vec_quantize_f32_to_i8(qi, x, N, 0.1f, 3);
+    vec_quantize_f32_to_u8(qu, x, N, 0.1f, 128);
+    printf("Vector width: %d\n", VEC_WIDTH);
+    printf("q(1e9)=%d q(-1e9)=%d q(0.25)=%d (expected 127 -128 5)\n", qi[5], qi[6], qi[7]);
+
+    vec_dequantize_i8_to_f32(y, qi, N, 0.1f, 3);
+    for (size_t i = 0; i < N; i++) {
+        errors += y[i] != (float)(qi[i] - 3) * 0.1f;
+        if (fabsf(x[i]) < 12.0f) max_err = fmax(max_err, fabs(y[i] - x[i]));
+    }
+    vec_dequantize_u8_to_f32(y, qu, N, 0.1f, 128);
+    for (size_t i = 0; i < N; i++) errors += y[i] != (float)(qu[i] - 128) * 0.1f;
+    printf("per-tensor round-trip max err: %.4f (scale / 2 = 0.05)\n", max_err);
+
+    /* 逐通道 */
+    vec_quantize_f32_to_i8_per_channel(qi, x, ROWS, CH, scale, zp);
+    vec_quantize_f32_to_u8_per_channel(qu, x, ROWS, CH, scale, zp);
+    for (size_t r = 0; r < ROWS; r++)
+        for (size_t c = 0; c < CH; c++) {
+            errors += qi[r * CH + c] != ref_q(x[r * CH + c], scale[c], zp[c], -128, 127);
+            errors += qu[r * CH + c] != ref_q(x[r * CH + c], scale[c], zp[c], 0, 255);
+        }
+    vec_dequantize_i8_to_f32_per_channel(y, qi, ROWS, CH, scale, zp);
+    for (size_t r = 0; r < ROWS; r++)
+        for (size_t c = 0; c < CH; c++) errors += y[r * CH + c] != (float)(qi[r * CH + c] - zp[c]) * scale[c];
+    vec_dequantize_u8_to_f32_per_channel(y, qu, ROWS, CH, scale, zp);
+    for (size_t r = 0; r < ROWS; r++)
+        for (size_t c = 0; c < CH; c++) errors += y[r * CH + c] != (float)(qu[r * CH + c] - zp[c]) * scale[c];
+    /* 通道数超过一个 1/scale 分块（VEC_Q8_CBLOCK_） */
+    {
+        const size_t rows = 3, ch = 1100;
+        float* wx = (float*)malloc(rows * ch * sizeof(float));
+        float* ws = (float*)malloc(ch * sizeof(float));
+        int32_t* wz = (int32_t*)malloc(ch * sizeof(int32_t));
+        int8_t* wq = (int8_t*)malloc(rows * ch);
+        for (size_t i = 0; i < rows * ch; i++) wx[i] = ((float)rand() / RAND_MAX - 0.5f) * 8.0f;
+        for (size_t c = 0; c < ch; c++) {
+            ws[c] = 0.01f + 0.03f * (float)(c % 9);
+            wz[c] = (int32_t)(c % 5) - 2;
+        }
+        vec_quantize_f32_to_i8_per_channel(wq, wx, rows, ch, ws, wz);
+        for (size_t r = 0; r < rows; r++)
+            for (size_t c = 0; c < ch; c++) errors += wq[r * ch + c] != ref_q(wx[r * ch + c], ws[c], wz[c], -128, 127);
+        free(wx);
+        free(ws);
+        free(wz);
+        free(wq);
+    }
+    printf("Quantize / dequantize mismatches: %d\n", errors);
+
+    /* 点积：含 -128 * -128 与 255 * 127 等极值 */
+    errors = 0;
+    for (size_t i = 0; i < N; i++) {
+        qi[i] = (int8_t)(rand() % 256 - 128);
+        wb[i] = (int8_t)(rand() % 256 - 128);
+        qu[i] = (uint8_t)(rand() % 256);
+    }
+    for (size_t i = 0; i < 64; i++) { qi[i] = -128; wb[i] = (i % 2) ? -128 : 127; qu[i] = 255; }
+    for (size_t n = 0; n <= N; n += 29) {
+        int32_t ri = 0, ru = 0;
+        for (size_t i = 0; i < n; i++) {
+            ri += qi[i] * wb[i];
+            ru += qu[i] * wb[i];
+        }
+        errors += vec_dot_i8(qi, wb, n) != ri;
+        errors += vec_dot_u8i8(qu, wb, n) != ru;
+    }
+    printf("dot_i8(%d) = %d, dot_u8i8(%d) = %d\n", N, vec_dot_i8(qi, wb, N), N, vec_dot_u8i8(qu, wb, N));
+    printf("Dot product mismatches: %d\n", errors);
+
+    free(x);
+    free(y);
+    free(qi);
+    free(qu);
+    free(wb);
+    return 0;
+}
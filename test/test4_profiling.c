@@ -0,0 +1,42 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#define VEC_ENABLE_PROFILING
+#include "../vectorize.h"
+
+#define N (1 << 16)
+
+static void my_axpy(float* y, const float* x, float a, size_t n) {
+    size_t i = 0;
+    VEC_PROF_BEGIN(my_axpy);
+    vfloat32_t va = VEC_SET1_F(a);
+    for (; i + VEC_WIDTH <= n; i += VEC_WIDTH) {
+        VEC_STOREU_F(y + i, VEC_ADD_F(VEC_MUL_F(va, VEC_LOADU_F(x + i)), VEC_LOADU_F(y + i)));
+    }
+    for (; i < n; i++) y[i] += a * x[i];
+    VEC_PROF_END(my_axpy, n, 3 * n * sizeof(float));
+}
+
+int main() {
+    float* x = (float*)malloc(N * sizeof(float));
+    float* y = (float*)malloc(N * sizeof(float));
+    float total = 0.0f;
+
+    for (size_t i = 0; i < N; i++) {
+        x[i] = 1.0f;
+        y[i] = 0.0f;
+    }
+    for (int r = 0; r < 10; r++) {
+        my_axpy(y, x, 0.5f, N);
+        total += vec_sum_f32(y, N);
+    }
+    vec_scale_f32(y, y, N, 2.0f);
+
+    printf("Vector width: %d, total: %f\n", VEC_WIDTH, total);
+    vec_prof_dump_json(stdout);
+    vec_prof_thread_exit();
+
+    free(x);
+    free(y);
+    return 0;
+}
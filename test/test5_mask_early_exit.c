@@ -0,0 +1,38 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../vectorize.h"
+
+#define N (1 << 20)
+
+int main() {
+    float a[16], b[16];
+    float* data = (float*)malloc(N * sizeof(float));
+
+    for (int i = 0; i < 16; i++) {
+        a[i] = (float)i;
+        b[i] = (i % 3 == 1) ? 100.0f : -1.0f;
+    }
+
+    vfloat32_t va = VEC_LOADU_F(a);
+    vfloat32_t vb = VEC_LOADU_F(b);
+    vmask_t gt = VEC_CMPGT_F(vb, va);      /* lane 1, 4, 7, ... */
+    vmask_t ge0 = VEC_CMPGE_F(va, VEC_SETZERO_F());
+
+    printf("Vector width: %d\n", VEC_WIDTH);
+    printf("bits=0x%x any=%d all=%d count=%d first=%d\n",
+           VEC_MASK_BITS(gt), VEC_MASK_ANY(gt), VEC_MASK_ALL(gt), VEC_MASK_COUNT(gt), VEC_MASK_FIRST(gt));
+    printf("all(a >= 0)=%d, any(gt & ~gt)=%d, count(gt | ~gt)=%d\n",
+           VEC_MASK_ALL(ge0), VEC_MASK_ANY(VEC_MASK_ANDNOT(gt, gt)),
+           VEC_MASK_COUNT(VEC_MASK_OR(gt, VEC_MASK_NOT(gt))));
+
+    /* 查找第一个超过阈值的元素 */
+    for (size_t i = 0; i < N; i++) data[i] = (float)(i % 1000);
+    data[777777] = 5000.0f;
+    printf("first > 2000: %ld (expected 777777)\n", (long)vec_find_first_gt_f32(data, N, 2000.0f));
+    printf("first > 998.5: %ld (expected 999)\n", (long)vec_find_first_gt_f32(data, N, 998.5f));
+    printf("first > 9999: %ld (expected -1)\n", (long)vec_find_first_gt_f32(data, N, 9999.0f));
+
+    free(data);
+    return 0;
+}
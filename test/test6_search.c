@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "../vectorize.h"
+
+#define N 4096
+
+static ptrdiff_t ref_find_i32(const int32_t* p, size_t n, int32_t key) {
+    for (size_t i = 0; i < n; i++) if (p[i] == key) return (ptrdiff_t)i;
+    return -1;
+}
+
+static ptrdiff_t ref_find_any(const unsigned char* p, size_t n, const unsigned char* set, size_t nset) {
+    for (size_t i = 0; i < n; i++)
+        for (size_t k = 0; k < nset; k++) if (p[i] == set[k]) return (ptrdiff_t)i;
+    return -1;
+}
+
+int main() {
+    int32_t* ints = (int32_t*)malloc(N * sizeof(int32_t));
+    float* floats = (float*)malloc(N * sizeof(float));
+    unsigned char* bytes = (unsigned char*)malloc(N);
+    const unsigned char set[3] = {'x', 'y', 'z'};
+    int errors = 0;
+
+    srand(42);
+    for (size_t i = 0; i < N; i++) {
+        ints[i] = rand() % 5000;
+        floats[i] = (float)ints[i] * 0.25f;
+        bytes[i] = (unsigned char)('a' + rand() % 20);
+    }
+    floats[3000] = NAN;
+    bytes[2500] = 'y';
+
+    /* 覆盖各种起始偏移（对齐 / 非对齐）与长度（含尾部） */
+    for (size_t off = 0; off < 70; off++) {
+        for (size_t n = 0; off + n <= N; n += 37 + off) {
+            int32_t key = ints[off + n / 2];
+            if (n == 0) key = 1;
+            if (vec_find_i32(ints + off, n, key) != ref_find_i32(ints + off, n, key)) errors++;
+            if (vec_find_i32(ints + off, n, -1) != -1) errors++;
+            if (vec_find_f32(floats + off, n, (float)key * 0.25f, 0.0f) != ref_find_i32(ints + off, n, key)) errors++;
+            const unsigned char* hit = (const unsigned char*)memchr(bytes + off, 'q', n);
+            if (vec_find_byte(bytes + off, n, 'q') != (hit ? hit - (bytes + off) : -1)) errors++;
+            if (vec_find_any_of_bytes(bytes + off, n, set, 3) != ref_find_any(bytes + off, n, set, 3)) errors++;
+        }
+    }
+
+    printf("Vector width: %d\n", VEC_WIDTH);
+    printf("find_i32(ints[123])  : %ld\n", (long)vec_find_i32(ints, N, ints[123]));
+    printf("find_f32(12.5, 0.3)  : %ld\n", (long)vec_find_f32(floats, N, 12.5f, 0.3f));
+    printf("find_nan             : %ld (expected 3000)\n", (long)vec_find_nan_f32(floats, N));
+    printf("count_eq_i32(ints[0]): %lu\n", (unsigned long)vec_count_eq_i32(ints, N, ints[0]));
+    printf("count_eq_f32(flt[7]) : %lu\n", (unsigned long)vec_count_eq_f32(floats, N, floats[7]));
+    printf("find_byte('y')       : %ld (expected 2500)\n", (long)vec_find_byte(bytes, N, 'y'));
+    printf("find_any_of(\"xyz\")   : %ld (expected 2500)\n", (long)vec_find_any_of_bytes(bytes, N, set, 3));
+    printf("Mismatches against scalar reference: %d\n", errors);
+
+    free(ints);
+    free(floats);
+    free(bytes);
+    return 0;
+}
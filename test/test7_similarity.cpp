@@ -0,0 +1,82 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include "../vectorize.h"
+
+constexpr size_t NVEC = 20000;
+constexpr size_t NQ = 4;
+constexpr size_t K = 5;
+
+static float naive(int metric, const float* q, const float* x, size_t dim) {
+    double dot = 0, qq = 0, xx = 0, l2 = 0;
+    for (size_t i = 0; i < dim; i++) {
+        dot += q[i] * x[i];
+        qq += q[i] * q[i];
+        xx += x[i] * x[i];
+        l2 += (q[i] - x[i]) * (q[i] - x[i]);
+    }
+    if (metric == VEC_METRIC_L2) return (float)l2;
+    if (metric == VEC_METRIC_IP) return (float)dot;
+    return (float)(dot / std::sqrt(qq * xx));
+}
+
+int main() {
+    const size_t dims[] = {64, 100, 768};
+    for (size_t dim : dims) {
+        std::vector<float> db(NVEC * dim), qs(NQ * dim), out(NQ * NVEC);
+        std::vector<size_t> idx(NQ * K);
+        std::vector<float> score(NQ * K);
+        for (auto& v : db) v = (float)std::rand() / RAND_MAX - 0.5f;
+        for (auto& v : qs) v = (float)std::rand() / RAND_MAX - 0.5f;
+
+        double max_err = 0.0;
+        int topk_bad = 0;
+        for (int metric = VEC_METRIC_L2; metric <= VEC_METRIC_COSINE; metric++) {
+            if (metric == VEC_METRIC_L2) vec_l2_batch(qs.data(), NQ, db.data(), NVEC, dim, out.data());
+            if (metric == VEC_METRIC_IP) vec_ip_batch(qs.data(), NQ, db.data(), NVEC, dim, out.data());
+            if (metric == VEC_METRIC_COSINE) vec_cosine_batch(qs.data(), NQ, db.data(), NVEC, dim, out.data());
+            for (size_t i = 0; i < NQ; i++)
+                for (size_t j = 0; j < NVEC; j += 7) {
+                    double ref = naive(metric, &qs[i * dim], &db[j * dim], dim);
+                    double err = std::fabs(out[i * NVEC + j] - ref) / (1.0 + std::fabs(ref));
+                    if (err > max_err) max_err = err;
+                }
+
+            // top-k 与全量计算后的结果比较：每个查询的 top1 一致，且得分按相近程度有序
+            vec_topk_batch(metric, qs.data(), NQ, db.data(), NVEC, dim, K, idx.data(), score.data());
+            for (size_t i = 0; i < NQ; i++) {
+                const float* o = &out[i * NVEC];
+                size_t best = 0;
+                for (size_t j = 1; j < NVEC; j++)
+                    if (metric == VEC_METRIC_L2 ? o[j] < o[best] : o[j] > o[best]) best = j;
+                topk_bad += idx[i * K] != best;
+                for (size_t j = 1; j < K; j++) {
+                    float a = score[i * K + j - 1], b = score[i * K + j];
+                    topk_bad += metric == VEC_METRIC_L2 ? a > b : a < b;
+                }
+            }
+        }
+
+        // k > nvec：多余位置下标为 (size_t)-1，得分为该度量下的最差值
+        for (int metric = VEC_METRIC_L2; metric <= VEC_METRIC_COSINE; metric++) {
+            vec_topk_batch(metric, qs.data(), NQ, db.data(), 3, dim, K, idx.data(), score.data());
+            for (size_t i = 0; i < NQ; i++)
+                for (size_t j = 3; j < K; j++) {
+                    topk_bad += idx[i * K + j] != (size_t)-1;
+                    topk_bad += score[i * K + j] != (metric == VEC_METRIC_L2 ? INFINITY : -INFINITY);
+                }
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        vec_ip_batch(qs.data(), 1, db.data(), NVEC, dim, out.data());
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+
+        std::cout << "dim " << dim << ": max rel err " << max_err
+                  << ", top-k mismatches " << topk_bad
+                  << ", 1x" << NVEC << " ip time " << elapsed.count() << " s\n";
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../vectorize.h"
+
+#define N (1 << 20)
+
+static void moments(const float* p, size_t n, double* mean, double* var) {
+    double s = 0.0, s2 = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        s += p[i];
+        s2 += (double)p[i] * p[i];
+    }
+    *mean = s / n;
+    *var = s2 / n - (*mean) * (*mean);
+}
+
+int main() {
+    float* a = (float*)malloc(N * sizeof(float));
+    float* b = (float*)malloc(N * sizeof(float));
+    vec_rng_t r1, r2;
+    double mean, var;
+    float lo = 1.0f, hi = 0.0f;
+    size_t tail_ok = 1;
+
+    vec_rng_seed(&r1, 12345, 0);
+    vec_fill_uniform_f32(&r1, a, N, 0.0f, 1.0f);
+    moments(a, N, &mean, &var);
+    for (size_t i = 0; i < N; i++) {
+        if (a[i] < lo) lo = a[i];
+        if (a[i] > hi) hi = a[i];
+    }
+    printf("Vector width: %d\n", VEC_WIDTH);
+    printf("uniform: mean %.4f (0.5), var %.4f (0.0833), range [%f, %f)\n", mean, var, lo, hi);
+
+    vec_rng_seed(&r1, 12345, 0);
+    vec_fill_normal_f32(&r1, a, N - 3, 2.0f, 3.0f);  /* 非整向量长度，覆盖尾部 */
+    moments(a, N - 3, &mean, &var);
+    printf("normal:  mean %.4f (2.0), var %.4f (9.0)\n", mean, var);
+
+    /* 相同种子与 stream 可复现；不同 stream 互不相同；jump 等价于 stream + 1 */
+    vec_rng_seed(&r1, 7, 0);
+    vec_rng_seed(&r2, 7, 0);
+    vec_fill_uniform_f32(&r1, a, 1000, 0.0f, 1.0f);
+    vec_fill_uniform_f32(&r2, b, 1000, 0.0f, 1.0f);
+    printf("same seed reproducible: %s\n", memcmp(a, b, 1000 * sizeof(float)) == 0 ? "yes" : "no");
+
+    vec_rng_seed(&r1, 7, 0);
+    vec_rng_jump(&r1);
+    vec_rng_seed(&r2, 7, 1);
+    vec_fill_uniform_f32(&r1, a, 1000, 0.0f, 1.0f);
+    vec_fill_uniform_f32(&r2, b, 1000, 0.0f, 1.0f);
+    printf("jump == stream 1: %s\n", memcmp(a, b, 1000 * sizeof(float)) == 0 ? "yes" : "no");
+
+    vec_rng_seed(&r2, 7, 2);
+    vec_fill_uniform_f32(&r2, b, 1000, 0.0f, 1.0f);
+    printf("stream 1 != stream 2: %s\n", memcmp(a, b, 1000 * sizeof(float)) != 0 ? "yes" : "no");
+
+    for (size_t i = 0; i < 1000; i++) tail_ok &= (a[i] >= 0.0f && a[i] < 1.0f);
+    printf("uniform values in [0, 1): %s\n", tail_ok ? "yes" : "no");
+
+    /* [1, 2) 上 u * 1 + 1 会把接近 1 的 u 舍入到 2，结果仍不得等于 hi */
+    vec_rng_seed(&r1, 99, 0);
+    vec_fill_uniform_f32(&r1, a, N - 1, 1.0f, 2.0f);
+    tail_ok = 1;
+    for (size_t i = 0; i < N - 1; i++) tail_ok &= (a[i] >= 1.0f && a[i] < 2.0f);
+    printf("uniform values in [1, 2): %s\n", tail_ok ? "yes" : "no");
+
+    free(a);
+    free(b);
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "../vectorize.h"
+
+#define NMAX 4096
+
+/* 朴素 DFT（double 精度）作为参考 */
+static void naive_dft(const float* in, double* out, size_t n) {
+    for (size_t k = 0; k < n; k++) {
+        double re = 0.0, im = 0.0;
+        for (size_t j = 0; j < n; j++) {
+            double a = -2.0 * 3.14159265358979323846 * (double)((j * k) % n) / (double)n;
+            re += in[2 * j] * cos(a) - in[2 * j + 1] * sin(a);
+            im += in[2 * j] * sin(a) + in[2 * j + 1] * cos(a);
+        }
+        out[2 * k] = re;
+        out[2 * k + 1] = im;
+    }
+}
+
+int main() {
+    float* x = (float*)malloc(2 * NMAX * sizeof(float));
+    float* y = (float*)malloc(2 * (NMAX + 1) * sizeof(float));
+    float* z = (float*)malloc(2 * NMAX * sizeof(float));
+    double* ref = (double*)malloc(2 * NMAX * sizeof(double));
+    vec_fft_plan_t plan;
+    int errors = 0;
+
+    printf("Vector width: %d\n", VEC_WIDTH);
+    srand(1);
+    for (size_t n = 1; n <= NMAX; n *= 2) {
+        double err_c = 0.0, err_inv = 0.0, err_r = 0.0, err_rinv = 0.0, scale = sqrt((double)n);
+        for (size_t i = 0; i < 2 * n; i++) x[i] = (float)rand() / RAND_MAX - 0.5f;
+
+        /* 复数正变换与往返 */
+        if (vec_fft_plan_init(&plan, n) != 0) { printf("plan init failed for n=%lu\n", (unsigned long)n); return 1; }
+        naive_dft(x, ref, n);
+        vec_fft_c2c(&plan, x, y, VEC_FFT_FORWARD);
+        for (size_t i = 0; i < 2 * n; i++) err_c = fmax(err_c, fabs(y[i] - ref[i]) / scale);
+        vec_fft_c2c(&plan, y, y, VEC_FFT_INVERSE);
+        for (size_t i = 0; i < 2 * n; i++) err_inv = fmax(err_inv, fabs(y[i] - x[i]));
+        vec_fft_plan_free(&plan);
+
+        /* 实数变换：与虚部为 0 的复数 DFT 比较 */
+        if (n >= 2) {
+            if (vec_fft_plan_init_real(&plan, n) != 0) { printf("real plan init failed\n"); return 1; }
+            for (size_t i = 0; i < n; i++) { z[2 * i] = x[i]; z[2 * i + 1] = 0.0f; }
+            naive_dft(z, ref, n);
+            vec_fft_r2c(&plan, x, y);
+            for (size_t i = 0; i < n + 2; i++) err_r = fmax(err_r, fabs(y[i] - ref[i]) / scale);
+            vec_fft_c2r(&plan, y, z);
+            for (size_t i = 0; i < n; i++) err_rinv = fmax(err_rinv, fabs(z[i] - x[i]));
+            vec_fft_plan_free(&plan);
+        }
+
+        if (err_c > 1e-5 || err_inv > 1e-5 || err_r > 1e-5 || err_rinv > 1e-5) errors++;
+        if (n == 1 || n == 8 || n == 64 || n == 1024 || n == NMAX)
+            printf("n=%-5lu c2c err %.2e, roundtrip %.2e, r2c err %.2e, c2r roundtrip %.2e\n",
+                   (unsigned long)n, err_c, err_inv, err_r, err_rinv);
+    }
+    printf("plan init rejects n=12: %s\n", vec_fft_plan_init(&plan, 12) == -1 ? "yes" : "no");
+
+    /* r2c / c2r 收到复数计划时返回 -1，不写输出 */
+    vec_fft_plan_init(&plan, 8);
+    y[0] = 123.0f;
+    {
+        int rc = vec_fft_r2c(&plan, x, y), rc2 = vec_fft_c2r(&plan, x, y);
+        printf("r2c / c2r reject complex plan: %s\n", rc == -1 && rc2 == -1 && y[0] == 123.0f ? "yes" : "no");
+    }
+    vec_fft_plan_free(&plan);
+
+    /* 复数乘法 / 共轭乘法 / 模 */
+    {
+        double e = 0.0;
+        size_t n = 37;
+        vec_cmul_f32(y, x, x + 2 * n, n);
+        vec_cmulconj_f32(z, x, x + 2 * n, n);
+        for (size_t k = 0; k < n; k++) {
+            double ar = x[2 * k], ai = x[2 * k + 1], br = x[2 * (n + k)], bi = x[2 * (n + k) + 1];
+            e = fmax(e, fabs(y[2 * k] - (ar * br - ai * bi)) + fabs(y[2 * k + 1] - (ar * bi + ai * br)));
+            e = fmax(e, fabs(z[2 * k] - (ar * br + ai * bi)) + fabs(z[2 * k + 1] - (ai * br - ar * bi)));
+        }
+        vec_cabs_f32(y, x, n);
+        for (size_t k = 0; k < n; k++) e = fmax(e, fabs(y[k] - hypot(x[2 * k], x[2 * k + 1])));
+        printf("cmul / cmulconj / cabs max err: %.2e\n", e);
+        if (e > 1e-6) errors++;
+    }
+    printf("Sizes / checks out of tolerance: %d\n", errors);
+
+    free(x);
+    free(y);
+    free(z);
+    free(ref);
+    return 0;
+}
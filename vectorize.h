@@ -22,6 +22,20 @@
 
 #define VECTORIZE_HEADER_H_VERSION 0.1
 
+/* ---------- 编译器诊断 ---------- */
+/* 只在本头文件范围内关闭以下误报，文件末尾恢复：
+ *  - 标量尾循环 for (; i < n; ++i) 内联到 n 为常量的调用处后，GCC 会报 -Waggressive-loop-optimizations；
+ *  - GCC 12 的 AVX-512 内建函数以 _mm512_undefined_* 作为直通源操作数，C++ 下内联后会误报
+ *    -Wmaybe-uninitialized / -Wuninitialized。 */
+#if defined(__GNUC__) && !defined(__clang__)
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Waggressive-loop-optimizations"
+  #if defined(__cplusplus) && __GNUC__ == 12
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    #pragma GCC diagnostic ignored "-Wuninitialized"
+  #endif
+#endif
+
 /* ---------- 平台检测与头文件包含 ---------- */
 
 #if defined(__x86_64__) || defined(__i386__)
@@ -76,12 +90,29 @@
   #define VEC_CALC_USABLE 0
 #endif
 
+/* 当前选中的后端名称（字符串），便于日志 / 性能剖析输出 */
+#if defined(VEC_IMPL_AVX512)
+  #define VEC_IMPL_NAME "AVX-512"
+#elif defined(VEC_IMPL_AVX) && defined(__AVX2__)
+  #define VEC_IMPL_NAME "AVX2"
+#elif defined(VEC_IMPL_AVX)
+  #define VEC_IMPL_NAME "AVX"
+#elif defined(VEC_IMPL_SSE)
+  #define VEC_IMPL_NAME "SSE"
+#elif defined(VEC_IMPL_NEON)
+  #define VEC_IMPL_NAME "NEON"
+#elif defined(VEC_IMPL_RISCV)
+  #define VEC_IMPL_NAME "RVV"
+#else
+  #define VEC_IMPL_NAME "scalar"
+#endif
+
 /* ---------- 类型与宽度定义 ---------- */
 
 #if defined(VEC_IMPL_AVX512)
   typedef __m512 vfloat32_t;       /* 16 x float32 */
   typedef __m512i vint_t;     /* integer version if needed */
-  typedef __m512 vmask_t;     /* mask is also __m512 in some intrinsics, but AVX-512 has k-registers; we use intrinsics directly */
+  typedef __mmask16 vmask_t;  /* AVX-512 比较结果为 k-mask（每 lane 1 bit），与 VEC_CMP*_F / VEC_SELECT 一致 */
   #define VEC_WIDTH_F 16
 #elif defined(VEC_IMPL_AVX)
   typedef __m256 vfloat32_t;        /* 8 x float32 */
@@ -283,7 +314,6 @@ static inline float32x4_t floorq_f32(float32x4_t a) {
   /* NEON 没有整除/取模指令 */
   #define VEC_DIV_I(a,b) VEC_DIV_I_SCALAR(a,b)
   #define VEC_MOD_I(a,b) VEC_MOD_I_SCALAR(a,b)
-}
 #else
   #define VEC_ADD_I(a,b) ((a)+(b))
   #define VEC_SUB_I(a,b) ((a)-(b))
@@ -345,30 +375,65 @@ static inline vint_t VEC_MOD_I_SCALAR(vint_t a, vint_t b) {
   #define VEC_I2F(a) (float)(a)
 #endif
 
-/* ---------- FMA (a*b + c) 支持vint_t和vfloat_t ---------- */
-#if (defined(__FMA__) || defined(__AVX2__) || defined(__AVX__))
+/* 浮点 -> int，四舍五入到最近偶数（x86 使用默认 MXCSR 舍入模式；ARMv7 用加减 1.5 * 2^23 实现，要求 |a| < 2^22） */
+#if defined(VEC_IMPL_AVX512)
+  #define VEC_F2I_RN(a) _mm512_cvtps_epi32(a)
+#elif defined(VEC_IMPL_AVX)
+  #define VEC_F2I_RN(a) _mm256_cvtps_epi32(a)
+#elif defined(VEC_IMPL_SSE)
+  #define VEC_F2I_RN(a) _mm_cvtps_epi32(a)
+#elif defined(VEC_IMPL_NEON) && defined(__aarch64__)
+  #define VEC_F2I_RN(a) vcvtnq_s32_f32(a)
+#elif defined(VEC_IMPL_NEON)
+  #define VEC_F2I_RN(a) vcvtq_s32_f32(vsubq_f32(vaddq_f32((a), vdupq_n_f32(12582912.0f)), vdupq_n_f32(12582912.0f)))
+#else
+  #define VEC_F2I_RN(a) ((int)lrintf(a))
+#endif
 
-  /* 如果编译器支持 FMA intrinsic */
-  #if defined(VEC_IMPL_AVX512)
-    #define VEC_FMA_F(a,b,c) _mm512_fmadd_ps((a),(b),(c))
-    #define VEC_FMA_I(a,b,c) _mm512_add_epi32(_mm512_mullo_epi32((a),(b)), (c))
-  #elif defined(VEC_IMPL_AVX)
-    #define VEC_FMA_F(a,b,c) _mm256_fmadd_ps((a),(b),(c))
-    #define VEC_FMA_I(a,b,c) _mm256_add_epi32(_mm256_mullo_epi32((a),(b)), (c))
-  #elif defined(VEC_IMPL_SSE) && defined(__FMA__)
-    #define VEC_FMA_F(a,b,c) _mm_fmadd_ps((a),(b),(c))
-    #define VEC_FMA_I(a,b,c) _mm_add_epi32(_mm_mullo_epi32((a),(b)), (c))
-  #else
-    /* fallback */
-    #define VEC_FMA_F(a,b,c) (VEC_ADD_F(VEC_MUL_F((a),(b)), (c)))
-    #define VEC_FMA_I(a,b,c) (VEC_ADD_I(VEC_MUL_I((a),(b)), (c)))
-  #endif
+/* 按位重新解释（不做数值转换）：float 向量 <-> int 向量 */
+#if defined(VEC_IMPL_AVX512)
+  #define VEC_CAST_F2I(a) _mm512_castps_si512(a)
+  #define VEC_CAST_I2F(a) _mm512_castsi512_ps(a)
+#elif defined(VEC_IMPL_AVX)
+  #define VEC_CAST_F2I(a) _mm256_castps_si256(a)
+  #define VEC_CAST_I2F(a) _mm256_castsi256_ps(a)
+#elif defined(VEC_IMPL_SSE)
+  #define VEC_CAST_F2I(a) _mm_castps_si128(a)
+  #define VEC_CAST_I2F(a) _mm_castsi128_ps(a)
+#elif defined(VEC_IMPL_NEON)
+  #define VEC_CAST_F2I(a) vreinterpretq_s32_f32(a)
+  #define VEC_CAST_I2F(a) vreinterpretq_f32_s32(a)
+#else
+static inline int VEC_CAST_F2I(float a) {
+  union { float f; int i; } u;
+  u.f = a;
+  return u.i;
+}
+static inline float VEC_CAST_I2F(int a) {
+  union { float f; int i; } u;
+  u.i = a;
+  return u.f;
+}
+#endif
 
+/* ---------- FMA (a*b + c) 支持vint_t和vfloat_t ---------- */
+/* AVX / AVX2 本身不含 FMA 指令，需要编译器同时开启 FMA（如 `-mfma` / `-march=haswell`）才使用融合指令 */
+#if defined(VEC_IMPL_AVX512)
+  #define VEC_FMA_F(a,b,c) _mm512_fmadd_ps((a),(b),(c))
+  #define VEC_FMA_I(a,b,c) _mm512_add_epi32(_mm512_mullo_epi32((a),(b)), (c))
+#elif defined(VEC_IMPL_AVX) && defined(__FMA__)
+  #define VEC_FMA_F(a,b,c) _mm256_fmadd_ps((a),(b),(c))
+  #define VEC_FMA_I(a,b,c) _mm256_add_epi32(_mm256_mullo_epi32((a),(b)), (c))
+#elif defined(VEC_IMPL_SSE) && defined(__FMA__)
+  #define VEC_FMA_F(a,b,c) _mm_fmadd_ps((a),(b),(c))
+  #define VEC_FMA_I(a,b,c) _mm_add_epi32(_mm_mullo_epi32((a),(b)), (c))
+#elif defined(VEC_IMPL_NEON) && (defined(__aarch64__) || defined(__ARM_FEATURE_FMA))
+  #define VEC_FMA_F(a,b,c) vfmaq_f32((c),(a),(b))
+  #define VEC_FMA_I(a,b,c) vmlaq_s32((c),(a),(b))
 #else
   /* fallback */
   #define VEC_FMA_F(a,b,c) (VEC_ADD_F(VEC_MUL_F((a),(b)), (c)))
   #define VEC_FMA_I(a,b,c) (VEC_ADD_I(VEC_MUL_I((a),(b)), (c)))
-
 #endif
 
 
@@ -441,10 +506,10 @@ static inline vint_t VEC_MOD_I_SCALAR(vint_t a, vint_t b) {
   #define VEC_XOR_I(a,b) _mm_xor_si128((a),(b))
   #define VEC_NOT_I(a)   _mm_xor_si128((a), _mm_set1_epi32(-1))
 #elif defined(VEC_IMPL_NEON)
-  #define VEC_AND_I(a,b) vandq_u32((a),(b))
-  #define VEC_OR_I(a,b)  vorrq_u32((a),(b))
-  #define VEC_XOR_I(a,b) veorq_u32((a),(b))
-  #define VEC_NOT_I(a)   vmvnq_u32((a))
+  #define VEC_AND_I(a,b) vandq_s32((a),(b))
+  #define VEC_OR_I(a,b)  vorrq_s32((a),(b))
+  #define VEC_XOR_I(a,b) veorq_s32((a),(b))
+  #define VEC_NOT_I(a)   vmvnq_s32((a))
 #else
   #define VEC_AND_I(a,b) ((a) & (b))
   #define VEC_OR_I(a,b)  ((a) | (b))
@@ -513,14 +578,15 @@ static inline vint_t VEC_MOD_I_SCALAR(vint_t a, vint_t b) {
 
 #elif defined(VEC_IMPL_NEON)
   /* NEON 没有直接等价的全位掩码 float 比较，使用 vcle/vclt 等返回 uint32 masks */
-  #define VEC_CMPEQ_F(a,b)    vreinterpretq_u32_f32(vceqq_f32((a),(b)))
+  /* vc*q_f32 本身即返回 uint32x4_t 全位掩码；NaN 与自身比较不相等，据此实现 ord / unord */
+  #define VEC_CMPEQ_F(a,b)    vceqq_f32((a),(b))
   #define VEC_CMPNEQ_F(a,b)   vmvnq_u32(vceqq_f32((a),(b)))
-  #define VEC_CMPLT_F(a,b)    vreinterpretq_u32_f32(vcltq_f32((a),(b)))
-  #define VEC_CMPLE_F(a,b)    vreinterpretq_u32_f32(vcleq_f32((a),(b)))
-  #define VEC_CMPGT_F(a,b)    vreinterpretq_u32_f32(vcgtq_f32((a),(b)))
-  #define VEC_CMPGE_F(a,b)    vreinterpretq_u32_f32(vcgeq_f32((a),(b)))
-  #define VEC_CMPORD_F(a,b)   /* no direct, fallback to true mask */ vreinterpretq_u32_u32(vdupq_n_u32(0xFFFFFFFF))
-  #define VEC_CMPUNORD_F(a,b) /* no direct, fallback to zero */ vreinterpretq_u32_u32(vdupq_n_u32(0x0))
+  #define VEC_CMPLT_F(a,b)    vcltq_f32((a),(b))
+  #define VEC_CMPLE_F(a,b)    vcleq_f32((a),(b))
+  #define VEC_CMPGT_F(a,b)    vcgtq_f32((a),(b))
+  #define VEC_CMPGE_F(a,b)    vcgeq_f32((a),(b))
+  #define VEC_CMPORD_F(a,b)   vandq_u32(vceqq_f32((a),(a)), vceqq_f32((b),(b)))
+  #define VEC_CMPUNORD_F(a,b) vmvnq_u32(VEC_CMPORD_F(a,b))
 
   #define VEC_CMPNLT_F(a,b)   VEC_CMPGE_F(a,b)
   #define VEC_CMPNLE_F(a,b)   VEC_CMPGT_F(a,b)
@@ -543,6 +609,267 @@ static inline vint_t VEC_MOD_I_SCALAR(vint_t a, vint_t b) {
   #define VEC_CMPNGE_F(a,b)   VEC_CMPLT_F(a,b)
 #endif
 
+/* ---------- 比较操作：整数（返回与浮点比较相同的 vmask_t，可直接用于 VEC_MASK_* / VEC_SELECT） ---------- */
+#if defined(VEC_IMPL_AVX512)
+  #define VEC_CMPEQ_I(a,b)    _mm512_cmpeq_epi32_mask((a),(b))
+  #define VEC_CMPGT_I(a,b)    _mm512_cmpgt_epi32_mask((a),(b))
+#elif defined(VEC_IMPL_AVX)
+  #define VEC_CMPEQ_I(a,b)    _mm256_castsi256_ps(_mm256_cmpeq_epi32((a),(b)))
+  #define VEC_CMPGT_I(a,b)    _mm256_castsi256_ps(_mm256_cmpgt_epi32((a),(b)))
+#elif defined(VEC_IMPL_SSE)
+  #define VEC_CMPEQ_I(a,b)    _mm_castsi128_ps(_mm_cmpeq_epi32((a),(b)))
+  #define VEC_CMPGT_I(a,b)    _mm_castsi128_ps(_mm_cmpgt_epi32((a),(b)))
+#elif defined(VEC_IMPL_NEON)
+  #define VEC_CMPEQ_I(a,b)    vceqq_s32((a),(b))
+  #define VEC_CMPGT_I(a,b)    vcgtq_s32((a),(b))
+#else
+  #define VEC_CMPEQ_I(a,b)    ((a)==(b)?~0u:0u)
+  #define VEC_CMPGT_I(a,b)    ((a)>(b)?~0u:0u)
+#endif
+#define VEC_CMPLT_I(a,b) VEC_CMPGT_I(b,a)
+
+/* ---------- 掩码代数：统一检测 VEC_CMP*_F 的结果，无需先存回内存 ---------- */
+/*
+ * 各后端的掩码表示不同（AVX-512 为 k-mask，SSE/AVX 为全位浮点向量，NEON 为 uint32x4_t，标量为 0 / ~0u），
+ * 以下接口对所有后端语义一致，参数均为 VEC_CMP*_F 的返回值：
+ *
+ *   int     VEC_MASK_BITS(m)  : 每 lane 1 bit 的整数位图，lane 0 为最低位（x86 movemask / kmov，NEON 窄化）
+ *   int     VEC_MASK_ANY(m)   : 存在置位 lane 时非 0（AVX 为 vtestps，AVX-512 为 kortest）
+ *   int     VEC_MASK_ALL(m)   : 全部 lane 置位时非 0
+ *   int     VEC_MASK_COUNT(m) : 置位 lane 个数
+ *   int     VEC_MASK_FIRST(m) : 第一个置位 lane 的下标，没有则为 -1
+ *   vmask_t VEC_MASK_AND(a,b) / VEC_MASK_OR(a,b) / VEC_MASK_ANDNOT(a,b)（a & ~b）/ VEC_MASK_NOT(a)
+ *
+ * 典型用法：循环中 VEC_MASK_ANY 命中后立即退出，再用 VEC_MASK_FIRST 定位，见 vec_find_first_gt_f32。
+ */
+#if defined(__GNUC__)
+  #define VEC_POPCOUNT32_(x) __builtin_popcount((unsigned)(x))
+  #define VEC_POPCOUNT64_(x) __builtin_popcountll((unsigned long long)(x))
+  #define VEC_CTZ32_(x)      __builtin_ctz((unsigned)(x))
+#else
+static inline int VEC_POPCOUNT32_(unsigned x) {
+  int c = 0;
+  for (; x; x &= x - 1) ++c;
+  return c;
+}
+static inline int VEC_POPCOUNT64_(unsigned long long x) {
+  int c = 0;
+  for (; x; x &= x - 1) ++c;
+  return c;
+}
+static inline int VEC_CTZ32_(unsigned x) {
+  int c = 0;
+  for (; !(x & 1u); x >>= 1) ++c;
+  return c;
+}
+#endif
+
+#if defined(VEC_IMPL_AVX512)
+  #define VEC_MASK_BITS(m)      ((int)(unsigned)(m))
+  #define VEC_MASK_ANY(m)       ((m) != 0)
+  #define VEC_MASK_ALL(m)       ((unsigned)(m) == 0xFFFFu)
+  #define VEC_MASK_AND(a,b)     ((__mmask16)((a) & (b)))
+  #define VEC_MASK_OR(a,b)      ((__mmask16)((a) | (b)))
+  #define VEC_MASK_ANDNOT(a,b)  ((__mmask16)((a) & ~(b)))
+  #define VEC_MASK_NOT(a)       ((__mmask16)~(a))
+#elif defined(VEC_IMPL_AVX)
+  #define VEC_MASK_BITS(m)      _mm256_movemask_ps(m)
+  #define VEC_MASK_ANY(m)       (!_mm256_testz_ps((m),(m)))
+  #define VEC_MASK_ALL(m)       (_mm256_movemask_ps(m) == 0xFF)
+  #define VEC_MASK_AND(a,b)     _mm256_and_ps((a),(b))
+  #define VEC_MASK_OR(a,b)      _mm256_or_ps((a),(b))
+  #define VEC_MASK_ANDNOT(a,b)  _mm256_andnot_ps((b),(a))
+  #define VEC_MASK_NOT(a)       VEC_NOT_F(a)
+#elif defined(VEC_IMPL_SSE)
+  #define VEC_MASK_BITS(m)      _mm_movemask_ps(m)
+  #define VEC_MASK_ANY(m)       (_mm_movemask_ps(m) != 0)
+  #define VEC_MASK_ALL(m)       (_mm_movemask_ps(m) == 0xF)
+  #define VEC_MASK_AND(a,b)     _mm_and_ps((a),(b))
+  #define VEC_MASK_OR(a,b)      _mm_or_ps((a),(b))
+  #define VEC_MASK_ANDNOT(a,b)  _mm_andnot_ps((b),(a))
+  #define VEC_MASK_NOT(a)       VEC_NOT_F(a)
+#elif defined(VEC_IMPL_NEON)
+/* 把 4 x u32 掩码窄化为 4 x u16，作为一个 64 位整数检测（每 lane 16 bit），ARMv7 / AArch64 通用 */
+static inline uint64_t VEC_MASK_NARROW_(uint32x4_t m) {
+  return vget_lane_u64(vreinterpret_u64_u16(vmovn_u32(m)), 0);
+}
+static inline int VEC_MASK_BITS(uint32x4_t m) {
+  static const uint32_t lane_bits[4] = {1, 2, 4, 8};
+  uint32x4_t b = vandq_u32(m, vld1q_u32(lane_bits));
+  uint32x2_t s = vorr_u32(vget_low_u32(b), vget_high_u32(b));
+  return (int)(vget_lane_u32(s, 0) | vget_lane_u32(s, 1));
+}
+  #define VEC_MASK_ANY(m)       (VEC_MASK_NARROW_(m) != 0)
+  #define VEC_MASK_ALL(m)       (VEC_MASK_NARROW_(m) == ~(uint64_t)0)
+  #define VEC_MASK_AND(a,b)     vandq_u32((a),(b))
+  #define VEC_MASK_OR(a,b)      vorrq_u32((a),(b))
+  #define VEC_MASK_ANDNOT(a,b)  vbicq_u32((a),(b))
+  #define VEC_MASK_NOT(a)       vmvnq_u32(a)
+#else
+  #define VEC_MASK_BITS(m)      ((m) ? 1 : 0)
+  #define VEC_MASK_ANY(m)       ((m) != 0)
+  #define VEC_MASK_ALL(m)       ((m) != 0)
+  #define VEC_MASK_AND(a,b)     ((a) & (b))
+  #define VEC_MASK_OR(a,b)      ((a) | (b))
+  #define VEC_MASK_ANDNOT(a,b)  ((a) & ~(b))
+  #define VEC_MASK_NOT(a)       (~(a))
+#endif
+
+#define VEC_MASK_COUNT(m) VEC_POPCOUNT32_(VEC_MASK_BITS(m))
+
+static inline int VEC_MASK_FIRST_BITS_(int bits) {
+  return bits ? VEC_CTZ32_(bits) : -1;
+}
+#define VEC_MASK_FIRST(m) VEC_MASK_FIRST_BITS_(VEC_MASK_BITS(m))
+
+/* ---------- 位运算：移位 / 循环移位 / popcount / 前导零 (vint_t，按 32 位 lane) ---------- */
+/*
+ *   VEC_SLL_I(a,k) / VEC_SRL_I(a,k) / VEC_SRA_I(a,k)    : 所有 lane 左移 / 逻辑右移 / 算术右移 k 位，k 取 [0, 31]
+ *   VEC_SLLV_I(a,k) / VEC_SRLV_I(a,k) / VEC_SRAV_I(a,k) : 每 lane 按 vint_t k 的对应 lane 移位；k 取 [0, 32]，
+ *                                                        移满 32 位时逻辑移位得 0，算术移位得符号位填充
+ *   VEC_ROTL_I(a,k) / VEC_ROTLV_I(a,k)                  : 循环左移（立即数 / 每 lane），k 取 [0, 31]
+ *   VEC_POPCNT_I(a) : 每 lane 置位个数（AVX-512 VPOPCNTDQ；AVX-512BW / AVX2 / SSSE3 为 vpshufb 半字节查表；NEON 为 vcnt）
+ *   VEC_LZCNT_I(a)  : 每 lane 前导零个数，0 得 32（AVX-512CD vplzcntd；NEON vclz；其余经 float 指数求得）
+ *
+ * x86 上立即数版本应传编译期常量。SSE 没有每 lane 可变移位，逐 lane 回退（与 VEC_DIV_I 相同）。
+ */
+#include <stdint.h>
+
+/* 单 lane 的可变移位，op：0 左移，1 逻辑右移，2 算术右移，3 循环左移 */
+static inline int32_t vec_shift_lane_(int32_t x, int32_t k, int op) {
+  uint32_t u = (uint32_t)x, c = (uint32_t)k;
+  switch (op) {
+    case 0: return c >= 32 ? 0 : (int32_t)(u << c);
+    case 1: return c >= 32 ? 0 : (int32_t)(u >> c);
+    case 2: return x >> (c >= 32 ? 31 : c);
+    default: c &= 31; return (int32_t)((u << c) | (u >> ((32 - c) & 31)));
+  }
+}
+
+#if defined(VEC_IMPL_AVX512)
+  #define VEC_SLL_I(a,k)   _mm512_slli_epi32((a),(k))
+  #define VEC_SRL_I(a,k)   _mm512_srli_epi32((a),(k))
+  #define VEC_SRA_I(a,k)   _mm512_srai_epi32((a),(k))
+  #define VEC_SLLV_I(a,k)  _mm512_sllv_epi32((a),(k))
+  #define VEC_SRLV_I(a,k)  _mm512_srlv_epi32((a),(k))
+  #define VEC_SRAV_I(a,k)  _mm512_srav_epi32((a),(k))
+  #define VEC_ROTL_I(a,k)  _mm512_rol_epi32((a),(k))
+  #define VEC_ROTLV_I(a,k) _mm512_rolv_epi32((a),(k))
+#elif defined(VEC_IMPL_AVX)
+  #define VEC_SLL_I(a,k)   _mm256_slli_epi32((a),(k))
+  #define VEC_SRL_I(a,k)   _mm256_srli_epi32((a),(k))
+  #define VEC_SRA_I(a,k)   _mm256_srai_epi32((a),(k))
+  #define VEC_SLLV_I(a,k)  _mm256_sllv_epi32((a),(k))
+  #define VEC_SRLV_I(a,k)  _mm256_srlv_epi32((a),(k))
+  #define VEC_SRAV_I(a,k)  _mm256_srav_epi32((a),(k))
+  #define VEC_ROTL_I(a,k)  VEC_OR_I(VEC_SLL_I(a,k), VEC_SRL_I(a, 32 - (k)))
+  #define VEC_ROTLV_I(a,k) VEC_OR_I(VEC_SLLV_I(a,k), VEC_SRLV_I(a, VEC_SUB_I(VEC_SET1_I(32),(k))))
+#elif defined(VEC_IMPL_SSE)
+static inline vint_t vec_shiftv_lanes_(vint_t a, vint_t k, int op) {
+  int32_t x[4], c[4];
+  int i;
+  VEC_STOREU_I(x, a);
+  VEC_STOREU_I(c, k);
+  for (i = 0; i < 4; ++i) x[i] = vec_shift_lane_(x[i], c[i], op);
+  return VEC_LOADU_I(x);
+}
+  #define VEC_SLL_I(a,k)   _mm_slli_epi32((a),(k))
+  #define VEC_SRL_I(a,k)   _mm_srli_epi32((a),(k))
+  #define VEC_SRA_I(a,k)   _mm_srai_epi32((a),(k))
+  #define VEC_SLLV_I(a,k)  vec_shiftv_lanes_((a),(k),0)
+  #define VEC_SRLV_I(a,k)  vec_shiftv_lanes_((a),(k),1)
+  #define VEC_SRAV_I(a,k)  vec_shiftv_lanes_((a),(k),2)
+  #define VEC_ROTL_I(a,k)  VEC_OR_I(VEC_SLL_I(a,k), VEC_SRL_I(a, 32 - (k)))
+  #define VEC_ROTLV_I(a,k) vec_shiftv_lanes_((a),(k),3)
+#elif defined(VEC_IMPL_NEON)
+  /* vshl 的计数为负时右移；移满 32 位时逻辑移位得 0，算术移位得符号位 */
+  #define VEC_SLL_I(a,k)   vshlq_s32((a), vdupq_n_s32(k))
+  #define VEC_SRL_I(a,k)   vreinterpretq_s32_u32(vshlq_u32(vreinterpretq_u32_s32(a), vdupq_n_s32(-(k))))
+  #define VEC_SRA_I(a,k)   vshlq_s32((a), vdupq_n_s32(-(k)))
+  #define VEC_SLLV_I(a,k)  vshlq_s32((a),(k))
+  #define VEC_SRLV_I(a,k)  vreinterpretq_s32_u32(vshlq_u32(vreinterpretq_u32_s32(a), vnegq_s32(k)))
+  #define VEC_SRAV_I(a,k)  vshlq_s32((a), vnegq_s32(k))
+  #define VEC_ROTL_I(a,k)  VEC_OR_I(VEC_SLL_I(a,k), VEC_SRL_I(a, 32 - (k)))
+  #define VEC_ROTLV_I(a,k) VEC_OR_I(VEC_SLLV_I(a,k), VEC_SRLV_I(a, VEC_SUB_I(VEC_SET1_I(32),(k))))
+#else
+  #define VEC_SLL_I(a,k)   ((int)((unsigned)(a) << (k)))
+  #define VEC_SRL_I(a,k)   ((int)((unsigned)(a) >> (k)))
+  #define VEC_SRA_I(a,k)   ((a) >> (k))
+  #define VEC_SLLV_I(a,k)  vec_shift_lane_((a),(k),0)
+  #define VEC_SRLV_I(a,k)  vec_shift_lane_((a),(k),1)
+  #define VEC_SRAV_I(a,k)  vec_shift_lane_((a),(k),2)
+  #define VEC_ROTL_I(a,k)  vec_shift_lane_((a),(k),3)
+  #define VEC_ROTLV_I(a,k) vec_shift_lane_((a),(k),3)
+#endif
+
+/* popcount：vpshufb 查表得到每字节计数，再用 maddubs + madd 把 4 个字节加到 32 位 lane */
+#if defined(VEC_IMPL_AVX512) && defined(__AVX512VPOPCNTDQ__)
+  #define VEC_POPCNT_I(a) _mm512_popcnt_epi32(a)
+#elif defined(VEC_IMPL_AVX512) && defined(__AVX512BW__)
+static inline vint_t VEC_POPCNT_I(vint_t a) {
+  const __m512i lut = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+  const __m512i low = _mm512_set1_epi8(0x0F);
+  __m512i c = _mm512_add_epi8(_mm512_shuffle_epi8(lut, _mm512_and_si512(a, low)),
+                              _mm512_shuffle_epi8(lut, _mm512_and_si512(_mm512_srli_epi16(a, 4), low)));
+  return _mm512_madd_epi16(_mm512_maddubs_epi16(c, _mm512_set1_epi8(1)), _mm512_set1_epi16(1));
+}
+#elif defined(VEC_IMPL_AVX)
+static inline vint_t VEC_POPCNT_I(vint_t a) {
+  const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                       0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low = _mm256_set1_epi8(0x0F);
+  __m256i c = _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(a, low)),
+                              _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(a, 4), low)));
+  return _mm256_madd_epi16(_mm256_maddubs_epi16(c, _mm256_set1_epi8(1)), _mm256_set1_epi16(1));
+}
+#elif defined(VEC_IMPL_SSE) && defined(__SSSE3__)
+static inline vint_t VEC_POPCNT_I(vint_t a) {
+  const __m128i lut = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m128i low = _mm_set1_epi8(0x0F);
+  __m128i c = _mm_add_epi8(_mm_shuffle_epi8(lut, _mm_and_si128(a, low)),
+                           _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(a, 4), low)));
+  return _mm_madd_epi16(_mm_maddubs_epi16(c, _mm_set1_epi8(1)), _mm_set1_epi16(1));
+}
+#elif defined(VEC_IMPL_NEON)
+  #define VEC_POPCNT_I(a) vreinterpretq_s32_u32(vpaddlq_u16(vpaddlq_u8(vcntq_u8(vreinterpretq_u8_s32(a)))))
+#elif VEC_WIDTH_F > 1
+/* AVX-512F（无 BW）与 SSE2：32 位 SWAR */
+static inline vint_t VEC_POPCNT_I(vint_t a) {
+  a = VEC_SUB_I(a, VEC_AND_I(VEC_SRL_I(a, 1), VEC_SET1_I(0x55555555)));
+  a = VEC_ADD_I(VEC_AND_I(a, VEC_SET1_I(0x33333333)), VEC_AND_I(VEC_SRL_I(a, 2), VEC_SET1_I(0x33333333)));
+  a = VEC_AND_I(VEC_ADD_I(a, VEC_SRL_I(a, 4)), VEC_SET1_I(0x0F0F0F0F));
+  a = VEC_ADD_I(a, VEC_SRL_I(a, 8));
+  a = VEC_ADD_I(a, VEC_SRL_I(a, 16));
+  return VEC_AND_I(a, VEC_SET1_I(0x3F));
+}
+#else
+  #define VEC_POPCNT_I(a) VEC_POPCOUNT32_(a)
+#endif
+
+#if defined(VEC_IMPL_AVX512) && defined(__AVX512CD__)
+  #define VEC_LZCNT_I(a) _mm512_lzcnt_epi32(a)
+#elif defined(VEC_IMPL_NEON)
+  #define VEC_LZCNT_I(a) vclzq_s32(a)
+#elif VEC_WIDTH_F > 1
+/* 只保留每段连续 1 的最高位，转为 float 时不会进位到更高的 2 的幂，指数即最高置位的位置：
+ * lz = 158 - 指数域。a == 0 时得 158，截到 32；最高位为 1 时 float 为负、结果为负，置 0。 */
+static inline vint_t VEC_LZCNT_I(vint_t a) {
+  vint_t y = VEC_AND_I(a, VEC_NOT_I(VEC_SRL_I(a, 1)));
+  vint_t lz = VEC_SUB_I(VEC_SET1_I(158), VEC_SRL_I(VEC_CAST_F2I(VEC_I2F(y)), 23));
+  vint_t d = VEC_SUB_I(lz, VEC_SET1_I(32));
+  lz = VEC_ADD_I(VEC_SET1_I(32), VEC_AND_I(d, VEC_SRA_I(d, 31)));
+  return VEC_AND_I(lz, VEC_NOT_I(VEC_SRA_I(a, 31)));
+}
+#else
+static inline int VEC_LZCNT_I(int a) {
+  unsigned u = (unsigned)a;
+  int c = 0;
+  if (u == 0) return 32;
+  for (; !(u & 0x80000000u); u <<= 1) ++c;
+  return c;
+}
+#endif
+
 /* --------------------- GATHER / SCATTER ------------------------------ */
 /*
  * vfloat32_t VEC_GATHER_F(base, idx_vec)
@@ -576,7 +903,7 @@ static inline void VEC_SCATTER_F(float* base, vint_t idx, vfloat32_t vals) {
 #elif defined(VEC_IMPL_AVX512)
 /* AVX-512: use gather/scatter intrinsics */
 static inline vfloat32_t VEC_GATHER_F(const float* base, vint_t idx) {
-  return _mm512_i32gather_ps((const void*)base, idx, 4);
+  return _mm512_i32gather_ps(idx, (const void*)base, 4);
 }
 static inline void VEC_SCATTER_F(float* base, vint_t idx, vfloat32_t vals) {
   _mm512_i32scatter_ps((void*)base, idx, vals, 4);
@@ -731,13 +1058,13 @@ static inline vint_t VEC_GATHER_U8(const unsigned char* base, vint_t idx) {
 #else
   /* 非 AVX-512：回退实现：load then select per-lane (可能成本高，但保证正确) */
   #define VEC_MASK_LOADU_F(dst, mask, src) do { \
-      vvfloat32_t _tmp = VEC_LOADU_F(src); \
+      vfloat32_t _tmp = VEC_LOADU_F(src); \
       dst = VEC_SELECT((mask), dst, _tmp); \
   } while(0)
 
   #define VEC_MASK_STOREU_F(dst, mask, src) do { \
-      vvfloat32_t _cur = VEC_LOADU_F(dst); \
-      vvfloat32_t _merged = VEC_SELECT((mask), _cur, (src)); \
+      vfloat32_t _cur = VEC_LOADU_F(dst); \
+      vfloat32_t _merged = VEC_SELECT((mask), _cur, (src)); \
       VEC_STOREU_F((dst), _merged); \
   } while(0)
 #endif
@@ -745,6 +1072,24 @@ static inline vint_t VEC_GATHER_U8(const unsigned char* base, vint_t idx) {
 /* ---------- 其它辅助宏 ---------- */
 #define VEC_WIDTH VEC_WIDTH_F
 
+/* 软件预取（读，保留在所有缓存层级）；地址越界不会触发异常 */
+#if defined(__GNUC__)
+  #define VEC_PREFETCH(p) __builtin_prefetch((const void*)(p), 0, 3)
+#elif defined(VEC_IMPL_AVX512) || defined(VEC_IMPL_AVX) || defined(VEC_IMPL_SSE)
+  #define VEC_PREFETCH(p) _mm_prefetch((const char*)(p), _MM_HINT_T0)
+#else
+  #define VEC_PREFETCH(p) ((void)(p))
+#endif
+
+/* 强制内联：用于以编译期常量参数展开出专用版本的内部函数 */
+#if defined(__GNUC__)
+  #define VEC_FORCE_INLINE_ static inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+  #define VEC_FORCE_INLINE_ static __forceinline
+#else
+  #define VEC_FORCE_INLINE_ static inline
+#endif
+
 /* 将比较 mask 转换为 1.0f/0.0f 布尔向量（按位与 1.0f） */
 #if defined(VEC_IMPL_AVX512)
   #define VEC_MASK_TO_BOOL_F(mask) _mm512_maskz_mov_ps(mask, _mm512_set1_ps(1.0f))
@@ -765,5 +1110,2519 @@ static inline vint_t VEC_GATHER_U8(const unsigned char* base, vint_t idx) {
   #define VEC_AS_FLOAT_PTR(v) (&(v))
 #endif
 
+/* ---------- 水平归约：把一个向量的所有 lane 相加 ---------- */
+#if defined(VEC_IMPL_AVX512) || defined(VEC_IMPL_AVX)
+static inline float vec_reduce_add_256_(__m256 v) {
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 0x55));
+  return _mm_cvtss_f32(s);
+}
+#endif
+
+#if defined(VEC_IMPL_AVX512)
+/* 高低 256 位相加后复用 AVX 的水平加法（AVX512F 没有 _mm512_extractf32x8_ps，借 pd 版本提取） */
+  #define VEC_LO256_F_(v) _mm512_castps512_ps256(v)
+  #define VEC_HI256_F_(v) _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1))
+  #define VEC_LO256_I_(v) _mm512_castsi512_si256(v)
+  #define VEC_HI256_I_(v) _mm512_extracti64x4_epi64((v), 1)
+static inline float VEC_REDUCE_ADD_F(vfloat32_t v) {
+  return vec_reduce_add_256_(_mm256_add_ps(VEC_LO256_F_(v), VEC_HI256_F_(v)));
+}
+#elif defined(VEC_IMPL_AVX)
+  #define VEC_REDUCE_ADD_F(v) vec_reduce_add_256_(v)
+#elif defined(VEC_IMPL_SSE)
+static inline float VEC_REDUCE_ADD_F(vfloat32_t v) {
+  __m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 0x55));
+  return _mm_cvtss_f32(s);
+}
+#elif defined(VEC_IMPL_NEON)
+static inline float VEC_REDUCE_ADD_F(vfloat32_t v) {
+  #if defined(__aarch64__)
+  return vaddvq_f32(v);
+  #else
+  float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+  return vget_lane_f32(vpadd_f32(s, s), 0);
+  #endif
+}
+#else
+  #define VEC_REDUCE_ADD_F(v) (v)
+#endif
+
+/* ---------- 性能剖析：每内核计数器（需定义 VEC_ENABLE_PROFILING） ---------- */
+/*
+ * 未定义 VEC_ENABLE_PROFILING 时，下列宏全部展开为空操作，不产生任何代码。
+ *
+ *   VEC_PROF_BEGIN(tag);                 在内核入口处记录时间戳（tag 为标识符，同时作为内核名）
+ *   VEC_PROF_END(tag, elems, bytes);     累加调用次数、处理元素数、搬运字节数与 TSC 周期
+ *
+ * 本头文件的数组级内核已自带埋点；用户内核可按同样方式包裹：
+ *
+ *   void my_kernel(float* p, size_t n) {
+ *     VEC_PROF_BEGIN(my_kernel);
+ *     ...
+ *     VEC_PROF_END(my_kernel, n, n * sizeof(float));
+ *   }
+ *
+ * 计数器按线程存放，写入无锁、无共享缓存行争用；读取时汇总所有线程：
+ *   int  vec_prof_snapshot(out, max)  : 汇总到 vec_prof_entry_t 数组，返回内核个数
+ *   void vec_prof_dump_json(fp)       : 以 JSON 输出快照（包含后端名与 VEC_WIDTH）
+ *   void vec_prof_reset()             : 清零所有线程的计数器
+ *   void vec_prof_thread_exit()       : 线程退出前调用，关闭本线程的 perf 计数器 fd
+ *
+ * 额外定义 VEC_PROF_PERF（仅 Linux）时，每个线程通过 perf_event_open 打开一组硬件计数器
+ * （cycles / instructions / cache-misses，仅统计用户态），BEGIN/END 各读取一次（一次 read 系统调用）。
+ * 打不开（如 perf_event_paranoid 限制）时对应字段保持为 0。
+ *
+ * 周期计数：x86 使用 rdtsc，AArch64 使用 cntvct_el0（计时器 tick，而非核心周期），其它平台为纳秒。
+ * 需要 GCC / Clang（__atomic 内建与弱符号，多个翻译单元共享同一份内核注册表）。
+ * 每个线程的计数块在首次使用时分配，线程退出后仍保留，以便快照能看到已结束线程的数据。
+ */
+#if defined(VEC_ENABLE_PROFILING)
+
+#if !defined(__GNUC__)
+  #error "VEC_ENABLE_PROFILING requires GCC or Clang."
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+#elif !defined(__aarch64__)
+  #include <time.h>
+#endif
+#if defined(VEC_PROF_PERF)
+  #if !defined(__linux__)
+    #error "VEC_PROF_PERF requires Linux perf_event_open."
+  #endif
+  #include <linux/perf_event.h>
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+#ifndef VEC_PROF_MAX_KERNELS
+  #define VEC_PROF_MAX_KERNELS 64
+#endif
+#define VEC_PROF_HW_EVENTS 3  /* cycles, instructions, cache-misses */
+
+typedef struct {
+  uint64_t calls;
+  uint64_t elems;
+  uint64_t bytes;
+  uint64_t cycles;
+  uint64_t hw[VEC_PROF_HW_EVENTS];
+} vec_prof_counter_t;
+
+typedef struct {
+  const char* name;
+  vec_prof_counter_t total;
+} vec_prof_entry_t;
+
+typedef struct {
+  uint64_t tsc;
+  uint64_t hw[VEC_PROF_HW_EVENTS];
+} vec_prof_mark_t;
+
+typedef struct vec_prof_thread_ {
+  struct vec_prof_thread_* next;
+  int perf_fd[VEC_PROF_HW_EVENTS];  /* [0] 为组 leader，未打开时为 -1 */
+  vec_prof_counter_t counters[VEC_PROF_MAX_KERNELS];
+} vec_prof_thread_t;
+
+typedef struct {
+  const char* names[VEC_PROF_MAX_KERNELS];
+  int nkernels;
+  char lock;
+  vec_prof_thread_t* threads;
+} vec_prof_registry_t;
+
+/* 弱符号：所有翻译单元共用同一个注册表，以及每线程同一个计数块（否则每个翻译单元各注册一块、各开一组 perf fd） */
+__attribute__((weak)) vec_prof_registry_t vec_prof_registry_;
+__attribute__((weak)) __thread vec_prof_thread_t* vec_prof_tls_;
+
+static inline uint64_t vec_prof_ticks_(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t t;
+  __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(t));
+  return t;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+#if defined(VEC_PROF_PERF)
+/* 打开整组计数器；任一失败时关闭已打开的全部 fd，fds 全部置 -1 */
+static inline void vec_prof_perf_open_(int* fds) {
+  static const uint64_t events[VEC_PROF_HW_EVENTS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES
+  };
+  struct perf_event_attr attr;
+  int k, j;
+  for (k = 0; k < VEC_PROF_HW_EVENTS; ++k) fds[k] = -1;
+  for (k = 0; k < VEC_PROF_HW_EVENTS; ++k) {
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = events[k];
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.disabled = (k == 0);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fds[k] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, fds[0], 0);
+    if (fds[k] < 0) {
+      for (j = 0; j < k; ++j) {
+        close(fds[j]);
+        fds[j] = -1;
+      }
+      fds[k] = -1;
+      return;
+    }
+  }
+  ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+static inline void vec_prof_perf_read_(int fd, uint64_t* hw) {
+  uint64_t buf[1 + VEC_PROF_HW_EVENTS];
+  if (fd >= 0 && read(fd, buf, sizeof(buf)) == (ssize_t)sizeof(buf))
+    memcpy(hw, buf + 1, sizeof(uint64_t) * VEC_PROF_HW_EVENTS);
+  else
+    memset(hw, 0, sizeof(uint64_t) * VEC_PROF_HW_EVENTS);
+}
+#endif
+
+static inline vec_prof_thread_t* vec_prof_thread_(void) {
+  vec_prof_thread_t* t = vec_prof_tls_;
+  if (t == NULL) {
+    t = (vec_prof_thread_t*)calloc(1, sizeof(vec_prof_thread_t));
+    if (t == NULL) return NULL;
+#if defined(VEC_PROF_PERF)
+    vec_prof_perf_open_(t->perf_fd);
+#else
+    {
+      int k;
+      for (k = 0; k < VEC_PROF_HW_EVENTS; ++k) t->perf_fd[k] = -1;
+    }
+#endif
+    /* 无锁头插到线程链表 */
+    t->next = __atomic_load_n(&vec_prof_registry_.threads, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&vec_prof_registry_.threads, &t->next, t, 1,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+    vec_prof_tls_ = t;
+  }
+  return t;
+}
+
+/* 按名字查找或注册内核编号；结果由调用点的静态变量缓存，只在首次调用时加锁。
+ * 缓存值 -1 表示尚未注册，-2 表示内核表已满（不再重试，该内核不计数） */
+static inline int vec_prof_register_(const char* name) {
+  vec_prof_registry_t* r = &vec_prof_registry_;
+  int k, id = -1;
+  while (__atomic_test_and_set(&r->lock, __ATOMIC_ACQUIRE)) {
+  }
+  for (k = 0; k < r->nkernels; ++k)
+    if (strcmp(r->names[k], name) == 0) id = k;
+  if (id < 0 && r->nkernels < VEC_PROF_MAX_KERNELS) {
+    id = r->nkernels;
+    r->names[id] = name;
+    __atomic_store_n(&r->nkernels, id + 1, __ATOMIC_RELEASE);
+  }
+  __atomic_clear(&r->lock, __ATOMIC_RELEASE);
+  return id;
+}
+
+static inline void vec_prof_begin_(vec_prof_mark_t* m) {
+#if defined(VEC_PROF_PERF)
+  vec_prof_thread_t* t = vec_prof_thread_();
+  vec_prof_perf_read_(t ? t->perf_fd[0] : -1, m->hw);
+#endif
+  m->tsc = vec_prof_ticks_();
+}
+
+static inline void vec_prof_end_(int* id_cache, const char* name, const vec_prof_mark_t* m,
+                                 uint64_t elems, uint64_t bytes) {
+  uint64_t now = vec_prof_ticks_();
+  vec_prof_thread_t* t = vec_prof_thread_();
+  vec_prof_counter_t* c;
+  int id = __atomic_load_n(id_cache, __ATOMIC_RELAXED);
+  if (id == -1) {
+    id = vec_prof_register_(name);
+    __atomic_store_n(id_cache, id < 0 ? -2 : id, __ATOMIC_RELAXED);
+  }
+  if (t == NULL || id < 0) return;
+  c = &t->counters[id];
+  /* 只有本线程写入；relaxed 原子存储保证快照线程读到的不是撕裂值 */
+  __atomic_store_n(&c->calls, c->calls + 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&c->elems, c->elems + elems, __ATOMIC_RELAXED);
+  __atomic_store_n(&c->bytes, c->bytes + bytes, __ATOMIC_RELAXED);
+  __atomic_store_n(&c->cycles, c->cycles + (now - m->tsc), __ATOMIC_RELAXED);
+#if defined(VEC_PROF_PERF)
+  {
+    uint64_t hw[VEC_PROF_HW_EVENTS];
+    int k;
+    vec_prof_perf_read_(t->perf_fd[0], hw);
+    for (k = 0; k < VEC_PROF_HW_EVENTS; ++k)
+      __atomic_store_n(&c->hw[k], c->hw[k] + (hw[k] - m->hw[k]), __ATOMIC_RELAXED);
+  }
+#endif
+}
+
+#define VEC_PROF_BEGIN(tag) \
+  static int vec_prof_id_##tag = -1; \
+  vec_prof_mark_t vec_prof_mark_##tag; \
+  vec_prof_begin_(&vec_prof_mark_##tag)
+#define VEC_PROF_END(tag, elems, bytes) \
+  vec_prof_end_(&vec_prof_id_##tag, #tag, &vec_prof_mark_##tag, (uint64_t)(elems), (uint64_t)(bytes))
+
+static inline int vec_prof_snapshot(vec_prof_entry_t* out, int max) {
+  int n = __atomic_load_n(&vec_prof_registry_.nkernels, __ATOMIC_ACQUIRE);
+  vec_prof_thread_t* t;
+  int k, j;
+  if (n > max) n = max;
+  for (k = 0; k < n; ++k) {
+    memset(&out[k], 0, sizeof(out[k]));
+    out[k].name = vec_prof_registry_.names[k];
+  }
+  for (t = __atomic_load_n(&vec_prof_registry_.threads, __ATOMIC_ACQUIRE); t; t = t->next) {
+    for (k = 0; k < n; ++k) {
+      const vec_prof_counter_t* c = &t->counters[k];
+      out[k].total.calls  += __atomic_load_n(&c->calls, __ATOMIC_RELAXED);
+      out[k].total.elems  += __atomic_load_n(&c->elems, __ATOMIC_RELAXED);
+      out[k].total.bytes  += __atomic_load_n(&c->bytes, __ATOMIC_RELAXED);
+      out[k].total.cycles += __atomic_load_n(&c->cycles, __ATOMIC_RELAXED);
+      for (j = 0; j < VEC_PROF_HW_EVENTS; ++j)
+        out[k].total.hw[j] += __atomic_load_n(&c->hw[j], __ATOMIC_RELAXED);
+    }
+  }
+  return n;
+}
+
+/* 关闭本线程的硬件计数器 fd（leader 与各成员）；计数器数据保留，之后本线程的 hw 字段不再增长 */
+static inline void vec_prof_thread_exit(void) {
+  vec_prof_thread_t* t = vec_prof_tls_;
+  int k;
+  if (t == NULL) return;
+  for (k = VEC_PROF_HW_EVENTS - 1; k >= 0; --k) {
+#if defined(VEC_PROF_PERF)
+    if (t->perf_fd[k] >= 0) close(t->perf_fd[k]);
+#endif
+    t->perf_fd[k] = -1;
+  }
+}
+
+/* 清零只应在没有线程正在执行被剖析内核时调用，否则并发写入的增量可能丢失 */
+static inline void vec_prof_reset(void) {
+  vec_prof_thread_t* t;
+  for (t = __atomic_load_n(&vec_prof_registry_.threads, __ATOMIC_ACQUIRE); t; t = t->next) {
+    uint64_t* p = (uint64_t*)t->counters;
+    size_t k;
+    for (k = 0; k < VEC_PROF_MAX_KERNELS * (sizeof(vec_prof_counter_t) / sizeof(uint64_t)); ++k)
+      __atomic_store_n(&p[k], 0, __ATOMIC_RELAXED);
+  }
+}
+
+static inline void vec_prof_dump_json(FILE* fp) {
+  vec_prof_entry_t e[VEC_PROF_MAX_KERNELS];
+  int n = vec_prof_snapshot(e, VEC_PROF_MAX_KERNELS), k;
+  fprintf(fp, "{\"backend\":\"%s\",\"vec_width\":%d,\"kernels\":[", VEC_IMPL_NAME, VEC_WIDTH_F);
+  for (k = 0; k < n; ++k) {
+    const vec_prof_counter_t* c = &e[k].total;
+    fprintf(fp, "%s{\"name\":\"%s\",\"calls\":%llu,\"elements\":%llu,\"bytes\":%llu,\"cycles\":%llu,"
+                "\"hw_cycles\":%llu,\"hw_instructions\":%llu,\"hw_cache_misses\":%llu}",
+            k ? "," : "", e[k].name,
+            (unsigned long long)c->calls, (unsigned long long)c->elems,
+            (unsigned long long)c->bytes, (unsigned long long)c->cycles,
+            (unsigned long long)c->hw[0], (unsigned long long)c->hw[1], (unsigned long long)c->hw[2]);
+  }
+  fprintf(fp, "]}\n");
+}
+
+#else
+  #define VEC_PROF_BEGIN(tag) ((void)0)
+  #define VEC_PROF_END(tag, elems, bytes) ((void)0)
+#endif /* VEC_ENABLE_PROFILING */
+
+/* ---------- 数组级内核 ---------- */
+/*
+ * 以下函数直接处理整段 float 数组（非对齐指针亦可），尾部不足 VEC_WIDTH 的部分用标量补齐。
+ *
+ * float     vec_sum_f32(src, n)              : 返回 src[0..n) 之和（4 路累加器展开，隐藏加法延迟）
+ * void      vec_scale_f32(dst, src, n, s)    : dst[i] = src[i] * s（dst 可以等于 src）
+ * ptrdiff_t vec_find_first_gt_f32(src, n, t) : 第一个大于 t 的元素下标，没有则为 -1
+ */
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+static inline float vec_sum_f32(const float* src, size_t n) {
+  size_t i = 0;
+  float total;
+  VEC_PROF_BEGIN(vec_sum_f32);
+#if VEC_WIDTH_F > 1
+  vfloat32_t acc0 = VEC_SETZERO_F(), acc1 = VEC_SETZERO_F();
+  vfloat32_t acc2 = VEC_SETZERO_F(), acc3 = VEC_SETZERO_F();
+  for (; i + 4 * VEC_WIDTH_F <= n; i += 4 * VEC_WIDTH_F) {
+    acc0 = VEC_ADD_F(acc0, VEC_LOADU_F(src + i));
+    acc1 = VEC_ADD_F(acc1, VEC_LOADU_F(src + i + VEC_WIDTH_F));
+    acc2 = VEC_ADD_F(acc2, VEC_LOADU_F(src + i + 2 * VEC_WIDTH_F));
+    acc3 = VEC_ADD_F(acc3, VEC_LOADU_F(src + i + 3 * VEC_WIDTH_F));
+  }
+  for (; i + VEC_WIDTH_F <= n; i += VEC_WIDTH_F)
+    acc0 = VEC_ADD_F(acc0, VEC_LOADU_F(src + i));
+  total = VEC_REDUCE_ADD_F(VEC_ADD_F(VEC_ADD_F(acc0, acc1), VEC_ADD_F(acc2, acc3)));
+#else
+  total = 0.0f;
+#endif
+  for (; i < n; ++i) total += src[i];
+  VEC_PROF_END(vec_sum_f32, n, n * sizeof(float));
+  return total;
+}
+
+static inline void vec_scale_f32(float* dst, const float* src, size_t n, float s) {
+  size_t i = 0;
+  VEC_PROF_BEGIN(vec_scale_f32);
+#if VEC_WIDTH_F > 1
+  vfloat32_t vs = VEC_SET1_F(s);
+  for (; i + VEC_WIDTH_F <= n; i += VEC_WIDTH_F)
+    VEC_STOREU_F(dst + i, VEC_MUL_F(VEC_LOADU_F(src + i), vs));
+#endif
+  for (; i < n; ++i) dst[i] = src[i] * s;
+  VEC_PROF_END(vec_scale_f32, n, 2 * n * sizeof(float));
+}
+
+/* 返回第一个 src[i] > thr 的下标，没有则返回 -1；命中所在的向量后立即退出，不扫描剩余数据 */
+static inline ptrdiff_t vec_find_first_gt_f32(const float* src, size_t n, float thr) {
+  size_t i = 0;
+#if VEC_WIDTH_F > 1
+  vfloat32_t vt = VEC_SET1_F(thr);
+  for (; i + VEC_WIDTH_F <= n; i += VEC_WIDTH_F) {
+    vmask_t m = VEC_CMPGT_F(VEC_LOADU_F(src + i), vt);
+    if (VEC_MASK_ANY(m)) return (ptrdiff_t)i + VEC_MASK_FIRST(m);
+  }
+#endif
+  for (; i < n; ++i)
+    if (src[i] > thr) return (ptrdiff_t)i;
+  return -1;
+}
+
+/* ---------- 搜索：find / count / memchr 风格扫描 ---------- */
+/*
+ * ptrdiff_t vec_find_i32(src, n, key)           : 第一个等于 key 的下标
+ * ptrdiff_t vec_find_f32(src, n, key, tol)      : 第一个满足 |src[i] - key| <= tol 的下标（tol = 0 即精确相等）
+ * ptrdiff_t vec_find_nan_f32(src, n)            : 第一个 NaN 的下标
+ * ptrdiff_t vec_find_byte(src, n, c)            : 同 memchr，返回下标
+ * ptrdiff_t vec_find_any_of_bytes(src, n, set, nset) : 第一个属于 set[0..nset) 的字节下标（同 strpbrk，但不以 0 结束）
+ * size_t    vec_count_eq_i32(src, n, key) / vec_count_eq_f32(src, n, key) : 等于 key 的元素个数
+ * 没有找到时 find 系列返回 -1。
+ *
+ * find 系列先用一次非对齐加载检查第一个向量，随后跳到对齐地址（与第一个向量可能重叠，不影响结果），
+ * 主循环每轮对齐加载 4 个向量，把 4 个掩码 OR 起来只测试一次，命中后再逐个定位。
+ */
+
+/* find 循环骨架：PRED(v) 把加载的向量映射为 vmask_t，SPRED 为尾部标量判定（可引用 i_），结果写入 r */
+#define VEC_FIND_BODY_(r, src, n, LOADU, LOAD, PRED, SPRED) do { \
+    size_t i_ = 0; \
+    if ((n) >= VEC_WIDTH_F) { \
+      vmask_t m0_ = PRED(LOADU(src)), m1_, m2_, m3_; \
+      if (VEC_MASK_ANY(m0_)) { (r) = VEC_MASK_FIRST(m0_); break; } \
+      i_ = (size_t)(((uintptr_t)0 - (uintptr_t)(src)) & (VEC_WIDTH_F * 4 - 1)) / 4; \
+      if (i_ == 0) i_ = VEC_WIDTH_F; \
+      for (; i_ + 4 * VEC_WIDTH_F <= (n); i_ += 4 * VEC_WIDTH_F) { \
+        m0_ = PRED(LOAD((src) + i_)); \
+        m1_ = PRED(LOAD((src) + i_ + VEC_WIDTH_F)); \
+        m2_ = PRED(LOAD((src) + i_ + 2 * VEC_WIDTH_F)); \
+        m3_ = PRED(LOAD((src) + i_ + 3 * VEC_WIDTH_F)); \
+        if (VEC_MASK_ANY(VEC_MASK_OR(VEC_MASK_OR(m0_, m1_), VEC_MASK_OR(m2_, m3_)))) { \
+          if (VEC_MASK_ANY(m0_))      (r) = (ptrdiff_t)i_ + VEC_MASK_FIRST(m0_); \
+          else if (VEC_MASK_ANY(m1_)) (r) = (ptrdiff_t)(i_ + VEC_WIDTH_F) + VEC_MASK_FIRST(m1_); \
+          else if (VEC_MASK_ANY(m2_)) (r) = (ptrdiff_t)(i_ + 2 * VEC_WIDTH_F) + VEC_MASK_FIRST(m2_); \
+          else                        (r) = (ptrdiff_t)(i_ + 3 * VEC_WIDTH_F) + VEC_MASK_FIRST(m3_); \
+          break; \
+        } \
+      } \
+      if ((r) >= 0) break; \
+      for (; i_ + VEC_WIDTH_F <= (n); i_ += VEC_WIDTH_F) { \
+        m0_ = PRED(LOAD((src) + i_)); \
+        if (VEC_MASK_ANY(m0_)) { (r) = (ptrdiff_t)i_ + VEC_MASK_FIRST(m0_); break; } \
+      } \
+      if ((r) >= 0) break; \
+    } \
+    for (; i_ < (n); ++i_) \
+      if (SPRED) { (r) = (ptrdiff_t)i_; break; } \
+  } while (0)
+
+static inline ptrdiff_t vec_find_i32(const int32_t* src, size_t n, int32_t key) {
+  ptrdiff_t r = -1;
+  VEC_PROF_BEGIN(vec_find_i32);
+#if VEC_WIDTH_F > 1
+  vint_t vkey = VEC_SET1_I(key);
+  #define VEC_FIND_PRED_(v) VEC_CMPEQ_I((v), vkey)
+  VEC_FIND_BODY_(r, src, n, VEC_LOADU_I, VEC_LOAD_I, VEC_FIND_PRED_, src[i_] == key);
+  #undef VEC_FIND_PRED_
+#else
+  for (size_t i = 0; i < n; ++i)
+    if (src[i] == key) { r = (ptrdiff_t)i; break; }
+#endif
+  VEC_PROF_END(vec_find_i32, r < 0 ? n : (size_t)r + 1, (r < 0 ? n : (size_t)r + 1) * sizeof(int32_t));
+  return r;
+}
+
+static inline ptrdiff_t vec_find_f32(const float* src, size_t n, float key, float tol) {
+  ptrdiff_t r = -1;
+  VEC_PROF_BEGIN(vec_find_f32);
+#if VEC_WIDTH_F > 1
+  vfloat32_t vkey = VEC_SET1_F(key), vtol = VEC_SET1_F(tol);
+  /* |x - key| 用 max(x - key, key - x) 得到，避免依赖各后端不同的浮点位运算类型 */
+  #define VEC_FIND_PRED_(v) VEC_CMPLE_F(VEC_MAX_F(VEC_SUB_F((v), vkey), VEC_SUB_F(vkey, (v))), vtol)
+  VEC_FIND_BODY_(r, src, n, VEC_LOADU_F, VEC_LOAD_F, VEC_FIND_PRED_,
+                 (src[i_] - key <= tol && key - src[i_] <= tol));
+  #undef VEC_FIND_PRED_
+#else
+  for (size_t i = 0; i < n; ++i)
+    if (src[i] - key <= tol && key - src[i] <= tol) { r = (ptrdiff_t)i; break; }
+#endif
+  VEC_PROF_END(vec_find_f32, r < 0 ? n : (size_t)r + 1, (r < 0 ? n : (size_t)r + 1) * sizeof(float));
+  return r;
+}
+
+static inline ptrdiff_t vec_find_nan_f32(const float* src, size_t n) {
+  ptrdiff_t r = -1;
+  VEC_PROF_BEGIN(vec_find_nan_f32);
+#if VEC_WIDTH_F > 1
+  #define VEC_FIND_PRED_(v) VEC_CMPUNORD_F((v), (v))
+  VEC_FIND_BODY_(r, src, n, VEC_LOADU_F, VEC_LOAD_F, VEC_FIND_PRED_, src[i_] != src[i_]);
+  #undef VEC_FIND_PRED_
+#else
+  for (size_t i = 0; i < n; ++i)
+    if (src[i] != src[i]) { r = (ptrdiff_t)i; break; }
+#endif
+  VEC_PROF_END(vec_find_nan_f32, r < 0 ? n : (size_t)r + 1, (r < 0 ? n : (size_t)r + 1) * sizeof(float));
+  return r;
+}
+
+static inline size_t vec_count_eq_i32(const int32_t* src, size_t n, int32_t key) {
+  size_t i = 0, c = 0;
+  VEC_PROF_BEGIN(vec_count_eq_i32);
+#if VEC_WIDTH_F > 1
+  vint_t vkey = VEC_SET1_I(key);
+  for (; i + 4 * VEC_WIDTH_F <= n; i += 4 * VEC_WIDTH_F) {
+    c += (size_t)VEC_MASK_COUNT(VEC_CMPEQ_I(VEC_LOADU_I(src + i), vkey));
+    c += (size_t)VEC_MASK_COUNT(VEC_CMPEQ_I(VEC_LOADU_I(src + i + VEC_WIDTH_F), vkey));
+    c += (size_t)VEC_MASK_COUNT(VEC_CMPEQ_I(VEC_LOADU_I(src + i + 2 * VEC_WIDTH_F), vkey));
+    c += (size_t)VEC_MASK_COUNT(VEC_CMPEQ_I(VEC_LOADU_I(src + i + 3 * VEC_WIDTH_F), vkey));
+  }
+  for (; i + VEC_WIDTH_F <= n; i += VEC_WIDTH_F)
+    c += (size_t)VEC_MASK_COUNT(VEC_CMPEQ_I(VEC_LOADU_I(src + i), vkey));
+#endif
+  for (; i < n; ++i) c += (src[i] == key);
+  VEC_PROF_END(vec_count_eq_i32, n, n * sizeof(int32_t));
+  return c;
+}
+
+static inline size_t vec_count_eq_f32(const float* src, size_t n, float key) {
+  size_t i = 0, c = 0;
+  VEC_PROF_BEGIN(vec_count_eq_f32);
+#if VEC_WIDTH_F > 1
+  vfloat32_t vkey = VEC_SET1_F(key);
+  for (; i + 4 * VEC_WIDTH_F <= n; i += 4 * VEC_WIDTH_F) {
+    c += (size_t)VEC_MASK_COUNT(VEC_CMPEQ_F(VEC_LOADU_F(src + i), vkey));
+    c += (size_t)VEC_MASK_COUNT(VEC_CMPEQ_F(VEC_LOADU_F(src + i + VEC_WIDTH_F), vkey));
+    c += (size_t)VEC_MASK_COUNT(VEC_CMPEQ_F(VEC_LOADU_F(src + i + 2 * VEC_WIDTH_F), vkey));
+    c += (size_t)VEC_MASK_COUNT(VEC_CMPEQ_F(VEC_LOADU_F(src + i + 3 * VEC_WIDTH_F), vkey));
+  }
+  for (; i + VEC_WIDTH_F <= n; i += VEC_WIDTH_F)
+    c += (size_t)VEC_MASK_COUNT(VEC_CMPEQ_F(VEC_LOADU_F(src + i), vkey));
+#endif
+  for (; i < n; ++i) c += (src[i] == key);
+  VEC_PROF_END(vec_count_eq_f32, n, n * sizeof(float));
+  return c;
+}
+
+/* 字节扫描使用独立的 8-bit 比较：每字节 VEC_U8_BITS_PER_BYTE_ 个掩码位，合成一个 uint64_t 位图 */
+#if defined(VEC_IMPL_AVX512) && defined(__AVX512BW__)
+  typedef __m512i vec_u8_t_;
+  #define VEC_U8_BYTES_ 64
+  #define VEC_U8_BITS_PER_BYTE_ 1
+  #define VEC_U8_SET1_(c)    _mm512_set1_epi8((char)(c))
+  #define VEC_U8_LOADU_(p)   _mm512_loadu_si512((const void*)(p))
+  #define VEC_U8_LOAD_(p)    _mm512_load_si512((const void*)(p))
+  #define VEC_U8_EQ_(a,b)    _mm512_cmpeq_epi8_mask((a),(b))
+  #define VEC_U8_OR_(a,b)    ((a) | (b))
+  #define VEC_U8_BITS_(m)    ((uint64_t)(m))
+  typedef __mmask64 vec_u8_mask_t_;
+#elif defined(__AVX2__)
+  typedef __m256i vec_u8_t_;
+  #define VEC_U8_BYTES_ 32
+  #define VEC_U8_BITS_PER_BYTE_ 1
+  #define VEC_U8_SET1_(c)    _mm256_set1_epi8((char)(c))
+  #define VEC_U8_LOADU_(p)   _mm256_loadu_si256((const __m256i*)(p))
+  #define VEC_U8_LOAD_(p)    _mm256_load_si256((const __m256i*)(p))
+  #define VEC_U8_EQ_(a,b)    _mm256_cmpeq_epi8((a),(b))
+  #define VEC_U8_OR_(a,b)    _mm256_or_si256((a),(b))
+  #define VEC_U8_BITS_(m)    ((uint64_t)(uint32_t)_mm256_movemask_epi8(m))
+  typedef __m256i vec_u8_mask_t_;
+#elif (defined(VEC_IMPL_SSE) || defined(VEC_IMPL_AVX)) && defined(__SSE2__)
+  typedef __m128i vec_u8_t_;
+  #define VEC_U8_BYTES_ 16
+  #define VEC_U8_BITS_PER_BYTE_ 1
+  #define VEC_U8_SET1_(c)    _mm_set1_epi8((char)(c))
+  #define VEC_U8_LOADU_(p)   _mm_loadu_si128((const __m128i*)(p))
+  #define VEC_U8_LOAD_(p)    _mm_load_si128((const __m128i*)(p))
+  #define VEC_U8_EQ_(a,b)    _mm_cmpeq_epi8((a),(b))
+  #define VEC_U8_OR_(a,b)    _mm_or_si128((a),(b))
+  #define VEC_U8_BITS_(m)    ((uint64_t)(uint32_t)_mm_movemask_epi8(m))
+  typedef __m128i vec_u8_mask_t_;
+#elif defined(VEC_IMPL_NEON)
+  typedef uint8x16_t vec_u8_t_;
+  #define VEC_U8_BYTES_ 16
+  #define VEC_U8_BITS_PER_BYTE_ 4  /* vshrn 窄化后每字节 4 bit */
+  #define VEC_U8_SET1_(c)    vdupq_n_u8((uint8_t)(c))
+  #define VEC_U8_LOADU_(p)   vld1q_u8((const uint8_t*)(p))
+  #define VEC_U8_LOAD_(p)    VEC_U8_LOADU_(p)
+  #define VEC_U8_EQ_(a,b)    vceqq_u8((a),(b))
+  #define VEC_U8_OR_(a,b)    vorrq_u8((a),(b))
+  #define VEC_U8_BITS_(m)    vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0)
+  typedef uint8x16_t vec_u8_mask_t_;
+#endif
+
+#if defined(VEC_U8_BYTES_)
+  #if defined(__GNUC__)
+    #define VEC_CTZ64_(x) __builtin_ctzll((unsigned long long)(x))
+  #else
+static inline int VEC_CTZ64_(uint64_t x) {
+  int c = 0;
+  for (; !(x & 1u); x >>= 1) ++c;
+  return c;
+}
+  #endif
+  #define VEC_U8_FIRST_(bits) (VEC_CTZ64_(bits) / VEC_U8_BITS_PER_BYTE_)
+
+/* 与 VEC_FIND_BODY_ 相同的结构，按字节步进；PRED(v) 返回 vec_u8_mask_t_ */
+#define VEC_FIND_BYTES_BODY_(r, src, n, PRED, SPRED) do { \
+    size_t i_ = 0; \
+    uint64_t b_; \
+    if ((n) >= VEC_U8_BYTES_) { \
+      vec_u8_mask_t_ m0_ = PRED(VEC_U8_LOADU_(src)), m1_, m2_, m3_; \
+      if ((b_ = VEC_U8_BITS_(m0_)) != 0) { (r) = VEC_U8_FIRST_(b_); break; } \
+      i_ = (size_t)(((uintptr_t)0 - (uintptr_t)(src)) & (VEC_U8_BYTES_ - 1)); \
+      if (i_ == 0) i_ = VEC_U8_BYTES_; \
+      for (; i_ + 4 * VEC_U8_BYTES_ <= (n); i_ += 4 * VEC_U8_BYTES_) { \
+        m0_ = PRED(VEC_U8_LOAD_((src) + i_)); \
+        m1_ = PRED(VEC_U8_LOAD_((src) + i_ + VEC_U8_BYTES_)); \
+        m2_ = PRED(VEC_U8_LOAD_((src) + i_ + 2 * VEC_U8_BYTES_)); \
+        m3_ = PRED(VEC_U8_LOAD_((src) + i_ + 3 * VEC_U8_BYTES_)); \
+        if (VEC_U8_BITS_(VEC_U8_OR_(VEC_U8_OR_(m0_, m1_), VEC_U8_OR_(m2_, m3_))) != 0) { \
+          if ((b_ = VEC_U8_BITS_(m0_)) != 0)      (r) = (ptrdiff_t)i_ + VEC_U8_FIRST_(b_); \
+          else if ((b_ = VEC_U8_BITS_(m1_)) != 0) (r) = (ptrdiff_t)(i_ + VEC_U8_BYTES_) + VEC_U8_FIRST_(b_); \
+          else if ((b_ = VEC_U8_BITS_(m2_)) != 0) (r) = (ptrdiff_t)(i_ + 2 * VEC_U8_BYTES_) + VEC_U8_FIRST_(b_); \
+          else (r) = (ptrdiff_t)(i_ + 3 * VEC_U8_BYTES_) + VEC_U8_FIRST_(VEC_U8_BITS_(m3_)); \
+          break; \
+        } \
+      } \
+      if ((r) >= 0) break; \
+      for (; i_ + VEC_U8_BYTES_ <= (n); i_ += VEC_U8_BYTES_) { \
+        m0_ = PRED(VEC_U8_LOAD_((src) + i_)); \
+        if ((b_ = VEC_U8_BITS_(m0_)) != 0) { (r) = (ptrdiff_t)i_ + VEC_U8_FIRST_(b_); break; } \
+      } \
+      if ((r) >= 0) break; \
+    } \
+    for (; i_ < (n); ++i_) \
+      if (SPRED) { (r) = (ptrdiff_t)i_; break; } \
+  } while (0)
+#endif /* VEC_U8_BYTES_ */
+
+static inline ptrdiff_t vec_find_byte(const void* src_, size_t n, unsigned char c) {
+  const unsigned char* src = (const unsigned char*)src_;
+  ptrdiff_t r = -1;
+  VEC_PROF_BEGIN(vec_find_byte);
+#if defined(VEC_U8_BYTES_)
+  vec_u8_t_ vc = VEC_U8_SET1_(c);
+  #define VEC_FIND_PRED_(v) VEC_U8_EQ_((v), vc)
+  VEC_FIND_BYTES_BODY_(r, src, n, VEC_FIND_PRED_, src[i_] == c);
+  #undef VEC_FIND_PRED_
+#else
+  for (size_t i = 0; i < n; ++i)
+    if (src[i] == c) { r = (ptrdiff_t)i; break; }
+#endif
+  VEC_PROF_END(vec_find_byte, r < 0 ? n : (size_t)r + 1, r < 0 ? n : (size_t)r + 1);
+  return r;
+}
+
+/* nset <= VEC_FIND_MAX_SET_ 时逐个比较后 OR 合并；更大的集合回退到 256 项查找表的标量扫描 */
+#define VEC_FIND_MAX_SET_ 16
+
+#if defined(VEC_U8_BYTES_)
+static inline vec_u8_mask_t_ vec_u8_eq_any_(vec_u8_t_ v, const vec_u8_t_* keys, size_t nset) {
+  vec_u8_mask_t_ m = VEC_U8_EQ_(v, keys[0]);
+  size_t k;
+  for (k = 1; k < nset; ++k) m = VEC_U8_OR_(m, VEC_U8_EQ_(v, keys[k]));
+  return m;
+}
+#endif
+
+static inline ptrdiff_t vec_find_any_of_bytes(const void* src_, size_t n, const unsigned char* set, size_t nset) {
+  const unsigned char* src = (const unsigned char*)src_;
+  unsigned char table[256];
+  ptrdiff_t r = -1;
+  size_t k;
+  VEC_PROF_BEGIN(vec_find_any_of_bytes);
+  if (nset == 0) {
+    n = 0;
+  } else if (nset == 1) {
+    r = vec_find_byte(src, n, set[0]);
+  } else {
+    for (k = 0; k < 256; ++k) table[k] = 0;
+    for (k = 0; k < nset; ++k) table[set[k]] = 1;
+#if defined(VEC_U8_BYTES_)
+    if (nset <= VEC_FIND_MAX_SET_) {
+      vec_u8_t_ keys[VEC_FIND_MAX_SET_];
+      for (k = 0; k < nset; ++k) keys[k] = VEC_U8_SET1_(set[k]);
+      #define VEC_FIND_PRED_(v) vec_u8_eq_any_((v), keys, nset)
+      VEC_FIND_BYTES_BODY_(r, src, n, VEC_FIND_PRED_, table[src[i_]]);
+      #undef VEC_FIND_PRED_
+    } else
+#endif
+    {
+      for (k = 0; k < n; ++k)
+        if (table[src[k]]) { r = (ptrdiff_t)k; break; }
+    }
+  }
+  VEC_PROF_END(vec_find_any_of_bytes, r < 0 ? n : (size_t)r + 1, r < 0 ? n : (size_t)r + 1);
+  return r;
+}
+
+/* ---------- 向量相似度：一对多 / 多对多距离与 top-k ---------- */
+/*
+ * 数据库 db 为 nvec 行、每行 dim 个 float 的行主序矩阵；queries 为 nq 行同维矩阵。
+ *
+ * float vec_dot_f32(a, b, n) / vec_l2sq_f32(a, b, n)         : 单对向量的内积 / 平方 L2 距离
+ * void  vec_l2_batch(queries, nq, db, nvec, dim, out)       : out[i*nvec + j] = ||q_i - x_j||^2（平方 L2）
+ * void  vec_ip_batch(queries, nq, db, nvec, dim, out)       : out[i*nvec + j] = <q_i, x_j>
+ * void  vec_cosine_batch(queries, nq, db, nvec, dim, out)   : out[i*nvec + j] = <q_i, x_j> / (|q_i| |x_j|)，零向量得 0
+ * void  vec_topk_batch(metric, queries, nq, db, nvec, dim, k, out_idx, out_score)
+ *        : 融合 top-k，每个查询输出最相近的 k 个（VEC_METRIC_L2 取距离最小，IP / COSINE 取得分最大），
+ *          out_idx / out_score 各为 nq*k，按相近程度排序；k > nvec 时多余位置的下标为 (size_t)-1，
+ *          得分为该度量下的最差值（L2 为 +INFINITY，IP / COSINE 为 -INFINITY）。
+ *
+ * 实现：每次同时处理 4 行数据库向量，查询向量的每个分块只加载一次，4 个累加器直到行末才做水平归约；
+ * 处理当前 4 行时预取下 4 行。数据库按 VEC_SIM_TILE_ 行分块，块内依次处理所有查询，使该块停留在缓存中。
+ * dim 为 64 / 128 / 256 / 768 时走编译期常量展开的专用版本。
+ */
+enum { VEC_METRIC_L2 = 0, VEC_METRIC_IP = 1, VEC_METRIC_COSINE = 2 };
+
+#define VEC_SIM_TILE_ 256
+
+static inline float vec_dot_f32(const float* a, const float* b, size_t n) {
+  size_t i = 0;
+  float r;
+#if VEC_WIDTH_F > 1
+  vfloat32_t acc0 = VEC_SETZERO_F(), acc1 = VEC_SETZERO_F();
+  for (; i + 2 * VEC_WIDTH_F <= n; i += 2 * VEC_WIDTH_F) {
+    acc0 = VEC_FMA_F(VEC_LOADU_F(a + i), VEC_LOADU_F(b + i), acc0);
+    acc1 = VEC_FMA_F(VEC_LOADU_F(a + i + VEC_WIDTH_F), VEC_LOADU_F(b + i + VEC_WIDTH_F), acc1);
+  }
+  for (; i + VEC_WIDTH_F <= n; i += VEC_WIDTH_F)
+    acc0 = VEC_FMA_F(VEC_LOADU_F(a + i), VEC_LOADU_F(b + i), acc0);
+  r = VEC_REDUCE_ADD_F(VEC_ADD_F(acc0, acc1));
+#else
+  r = 0.0f;
+#endif
+  for (; i < n; ++i) r += a[i] * b[i];
+  return r;
+}
+
+static inline float vec_l2sq_f32(const float* a, const float* b, size_t n) {
+  size_t i = 0;
+  float r;
+#if VEC_WIDTH_F > 1
+  vfloat32_t acc0 = VEC_SETZERO_F(), acc1 = VEC_SETZERO_F();
+  for (; i + 2 * VEC_WIDTH_F <= n; i += 2 * VEC_WIDTH_F) {
+    vfloat32_t d0 = VEC_SUB_F(VEC_LOADU_F(a + i), VEC_LOADU_F(b + i));
+    vfloat32_t d1 = VEC_SUB_F(VEC_LOADU_F(a + i + VEC_WIDTH_F), VEC_LOADU_F(b + i + VEC_WIDTH_F));
+    acc0 = VEC_FMA_F(d0, d0, acc0);
+    acc1 = VEC_FMA_F(d1, d1, acc1);
+  }
+  for (; i + VEC_WIDTH_F <= n; i += VEC_WIDTH_F) {
+    vfloat32_t d0 = VEC_SUB_F(VEC_LOADU_F(a + i), VEC_LOADU_F(b + i));
+    acc0 = VEC_FMA_F(d0, d0, acc0);
+  }
+  r = VEC_REDUCE_ADD_F(VEC_ADD_F(acc0, acc1));
+#else
+  r = 0.0f;
+#endif
+  for (; i < n; ++i) r += (a[i] - b[i]) * (a[i] - b[i]);
+  return r;
+}
+
+/* 由内积与两个平方范数得到余弦相似度 */
+static inline float vec_cosine_from_dot_(float dot, float qq, float xx) {
+  float d = qq * xx;
+  return d > 0.0f ? dot / sqrtf(d) : 0.0f;
+}
+
+/* 4 行同时计算；x 指向第一行，行距 stride；pf 为下一组行的起始（用于预取，每 64 字节缓存行预取一次），
+ * 没有下一组时为 NULL。L2 时 out4 为平方距离，否则为内积；COSINE 时额外在 xx4 输出每行平方范数。 */
+#define VEC_SIM_LINE_F_ (64 / (int)sizeof(float))
+VEC_FORCE_INLINE_ void vec_sim_block4_(int metric, const float* q, const float* x, size_t stride,
+                                       size_t dim, const float* pf, float* out4, float* xx4) {
+  size_t i = 0;
+  int r;
+#if VEC_WIDTH_F > 1
+  const float* x0 = x;
+  const float* x1 = x + stride;
+  const float* x2 = x + 2 * stride;
+  const float* x3 = x + 3 * stride;
+  vfloat32_t a0 = VEC_SETZERO_F(), a1 = VEC_SETZERO_F(), a2 = VEC_SETZERO_F(), a3 = VEC_SETZERO_F();
+  vfloat32_t n0 = VEC_SETZERO_F(), n1 = VEC_SETZERO_F(), n2 = VEC_SETZERO_F(), n3 = VEC_SETZERO_F();
+  for (; i + VEC_WIDTH_F <= dim; i += VEC_WIDTH_F) {
+    vfloat32_t vq = VEC_LOADU_F(q + i);
+    vfloat32_t v0 = VEC_LOADU_F(x0 + i), v1 = VEC_LOADU_F(x1 + i);
+    vfloat32_t v2 = VEC_LOADU_F(x2 + i), v3 = VEC_LOADU_F(x3 + i);
+    if (pf != NULL && i % VEC_SIM_LINE_F_ == 0) {
+      VEC_PREFETCH(pf + i);
+      VEC_PREFETCH(pf + stride + i);
+      VEC_PREFETCH(pf + 2 * stride + i);
+      VEC_PREFETCH(pf + 3 * stride + i);
+    }
+    if (metric == VEC_METRIC_L2) {
+      v0 = VEC_SUB_F(vq, v0); v1 = VEC_SUB_F(vq, v1);
+      v2 = VEC_SUB_F(vq, v2); v3 = VEC_SUB_F(vq, v3);
+      a0 = VEC_FMA_F(v0, v0, a0); a1 = VEC_FMA_F(v1, v1, a1);
+      a2 = VEC_FMA_F(v2, v2, a2); a3 = VEC_FMA_F(v3, v3, a3);
+    } else {
+      a0 = VEC_FMA_F(vq, v0, a0); a1 = VEC_FMA_F(vq, v1, a1);
+      a2 = VEC_FMA_F(vq, v2, a2); a3 = VEC_FMA_F(vq, v3, a3);
+      if (metric == VEC_METRIC_COSINE) {
+        n0 = VEC_FMA_F(v0, v0, n0); n1 = VEC_FMA_F(v1, v1, n1);
+        n2 = VEC_FMA_F(v2, v2, n2); n3 = VEC_FMA_F(v3, v3, n3);
+      }
+    }
+  }
+  out4[0] = VEC_REDUCE_ADD_F(a0); out4[1] = VEC_REDUCE_ADD_F(a1);
+  out4[2] = VEC_REDUCE_ADD_F(a2); out4[3] = VEC_REDUCE_ADD_F(a3);
+  if (metric == VEC_METRIC_COSINE) {
+    xx4[0] = VEC_REDUCE_ADD_F(n0); xx4[1] = VEC_REDUCE_ADD_F(n1);
+    xx4[2] = VEC_REDUCE_ADD_F(n2); xx4[3] = VEC_REDUCE_ADD_F(n3);
+  }
+#else
+  (void)pf;
+  for (r = 0; r < 4; ++r) out4[r] = xx4[r] = 0.0f;
+#endif
+  for (; i < dim; ++i) {
+    for (r = 0; r < 4; ++r) {
+      float xv = x[r * stride + i];
+      if (metric == VEC_METRIC_L2) {
+        float d = q[i] - xv;
+        out4[r] += d * d;
+      } else {
+        out4[r] += q[i] * xv;
+        if (metric == VEC_METRIC_COSINE) xx4[r] += xv * xv;
+      }
+    }
+  }
+}
+
+/* 单个查询对 nrows 行计算相似度，写入 out[0..nrows)；qq 为查询平方范数（仅 COSINE 使用） */
+VEC_FORCE_INLINE_ void vec_sim_rows_dim_(int metric, const float* q, float qq, const float* db,
+                                         size_t nrows, size_t dim, float* out) {
+  float o[4], xx[4];
+  size_t j = 0;
+  int r;
+  for (; j + 4 <= nrows; j += 4) {
+    const float* x = db + j * dim;
+    const float* pf = (j + 8 <= nrows) ? x + 4 * dim : NULL;
+    vec_sim_block4_(metric, q, x, dim, dim, pf, o, xx);
+    for (r = 0; r < 4; ++r)
+      out[j + r] = (metric == VEC_METRIC_COSINE) ? vec_cosine_from_dot_(o[r], qq, xx[r]) : o[r];
+  }
+  for (; j < nrows; ++j) {
+    const float* x = db + j * dim;
+    float v;
+    if (metric == VEC_METRIC_L2) {
+      v = vec_l2sq_f32(q, x, dim);
+    } else if (metric == VEC_METRIC_IP) {
+      v = vec_dot_f32(q, x, dim);
+    } else {
+      v = vec_cosine_from_dot_(vec_dot_f32(q, x, dim), qq, vec_dot_f32(x, x, dim));
+    }
+    out[j] = v;
+  }
+}
+
+/* 常用维度分派到常量 dim 的内联展开版本 */
+VEC_FORCE_INLINE_ void vec_sim_rows_(int metric, const float* q, float qq, const float* db,
+                                     size_t nrows, size_t dim, float* out) {
+  switch (dim) {
+    case 64:  vec_sim_rows_dim_(metric, q, qq, db, nrows, 64, out); break;
+    case 128: vec_sim_rows_dim_(metric, q, qq, db, nrows, 128, out); break;
+    case 256: vec_sim_rows_dim_(metric, q, qq, db, nrows, 256, out); break;
+    case 768: vec_sim_rows_dim_(metric, q, qq, db, nrows, 768, out); break;
+    default:  vec_sim_rows_dim_(metric, q, qq, db, nrows, dim, out); break;
+  }
+}
+
+VEC_FORCE_INLINE_ void vec_sim_batch_(int metric, const float* queries, size_t nq, const float* db,
+                                      size_t nvec, size_t dim, float* out) {
+  size_t t, i;
+  for (t = 0; t < nvec; t += VEC_SIM_TILE_) {
+    size_t rows = (nvec - t < VEC_SIM_TILE_) ? nvec - t : VEC_SIM_TILE_;
+    for (i = 0; i < nq; ++i) {
+      const float* q = queries + i * dim;
+      float qq = (metric == VEC_METRIC_COSINE) ? vec_dot_f32(q, q, dim) : 0.0f;
+      vec_sim_rows_(metric, q, qq, db + t * dim, rows, dim, out + i * nvec + t);
+    }
+  }
+}
+
+static inline void vec_l2_batch(const float* queries, size_t nq, const float* db, size_t nvec,
+                                size_t dim, float* out) {
+  VEC_PROF_BEGIN(vec_l2_batch);
+  vec_sim_batch_(VEC_METRIC_L2, queries, nq, db, nvec, dim, out);
+  VEC_PROF_END(vec_l2_batch, nq * nvec * dim, (nq + nvec) * dim * sizeof(float));
+}
+
+static inline void vec_ip_batch(const float* queries, size_t nq, const float* db, size_t nvec,
+                                size_t dim, float* out) {
+  VEC_PROF_BEGIN(vec_ip_batch);
+  vec_sim_batch_(VEC_METRIC_IP, queries, nq, db, nvec, dim, out);
+  VEC_PROF_END(vec_ip_batch, nq * nvec * dim, (nq + nvec) * dim * sizeof(float));
+}
+
+static inline void vec_cosine_batch(const float* queries, size_t nq, const float* db, size_t nvec,
+                                    size_t dim, float* out) {
+  VEC_PROF_BEGIN(vec_cosine_batch);
+  vec_sim_batch_(VEC_METRIC_COSINE, queries, nq, db, nvec, dim, out);
+  VEC_PROF_END(vec_cosine_batch, nq * nvec * dim, (nq + nvec) * dim * sizeof(float));
+}
+
+/* top-k 最大堆：堆顶为当前 k 个里最差的一个，key 越小越相近 */
+static inline void vec_topk_sift_down_(float* key, size_t* idx, size_t n, size_t p) {
+  for (;;) {
+    size_t c = 2 * p + 1, m = p;
+    if (c < n && key[c] > key[m]) m = c;
+    if (c + 1 < n && key[c + 1] > key[m]) m = c + 1;
+    if (m == p) return;
+    { float tk = key[p]; key[p] = key[m]; key[m] = tk; }
+    { size_t ti = idx[p]; idx[p] = idx[m]; idx[m] = ti; }
+    p = m;
+  }
+}
+
+static inline void vec_topk_batch(int metric, const float* queries, size_t nq, const float* db,
+                                  size_t nvec, size_t dim, size_t k, size_t* out_idx, float* out_score) {
+  float buf[VEC_SIM_TILE_];
+  size_t kk = (k < nvec) ? k : nvec;
+  size_t t, i, j;
+  VEC_PROF_BEGIN(vec_topk_batch);
+  if (k == 0) nq = 0;
+  /* 输出数组直接用作每个查询的堆，先以“无穷差”填满 */
+  for (i = 0; i < nq * k; ++i) {
+    out_idx[i] = (size_t)-1;
+    out_score[i] = INFINITY;
+  }
+  for (t = 0; t < nvec; t += VEC_SIM_TILE_) {
+    size_t rows = (nvec - t < VEC_SIM_TILE_) ? nvec - t : VEC_SIM_TILE_;
+    for (i = 0; i < nq; ++i) {
+      const float* q = queries + i * dim;
+      float* key = out_score + i * k;
+      size_t* idx = out_idx + i * k;
+      float qq = 0.0f;
+      if (metric == VEC_METRIC_L2) {
+        vec_sim_rows_(VEC_METRIC_L2, q, qq, db + t * dim, rows, dim, buf);
+      } else if (metric == VEC_METRIC_IP) {
+        vec_sim_rows_(VEC_METRIC_IP, q, qq, db + t * dim, rows, dim, buf);
+      } else {
+        qq = vec_dot_f32(q, q, dim);
+        vec_sim_rows_(VEC_METRIC_COSINE, q, qq, db + t * dim, rows, dim, buf);
+      }
+      for (j = 0; j < rows; ++j) {
+        float b = (metric == VEC_METRIC_L2) ? buf[j] : -buf[j];
+        if (b < key[0]) {
+          key[0] = b;
+          idx[0] = t + j;
+          vec_topk_sift_down_(key, idx, kk, 0);
+        }
+      }
+    }
+  }
+  /* 堆排序：依次把堆顶（最差）换到末尾，得到由近到远的顺序，再还原得分符号 */
+  for (i = 0; i < nq; ++i) {
+    float* key = out_score + i * k;
+    size_t* idx = out_idx + i * k;
+    for (j = kk; j > 1; --j) {
+      { float tk = key[0]; key[0] = key[j - 1]; key[j - 1] = tk; }
+      { size_t ti = idx[0]; idx[0] = idx[j - 1]; idx[j - 1] = ti; }
+      vec_topk_sift_down_(key, idx, j - 1, 0);
+    }
+    /* 连同 kk..k-1 的填充位一起取反，IP / COSINE 下填充位得 -INFINITY */
+    if (metric != VEC_METRIC_L2)
+      for (j = 0; j < k; ++j) key[j] = -key[j];
+  }
+  VEC_PROF_END(vec_topk_batch, nq * nvec * dim, (nq + nvec) * dim * sizeof(float));
+}
+
+/* ---------- 伪随机数：每 lane 一个 xoshiro128+ 生成器 ---------- */
+/*
+ * vec_rng_t 含 VEC_WIDTH 个相互独立的 xoshiro128+ 状态（每 lane 一个，lane 之间相隔 2^64 步）。
+ *
+ * void       vec_rng_seed(r, seed, stream) : 由 64 位种子初始化；stream 不同的生成器相隔 2^96 步，
+ *                                            可用线程号作为 stream，使并行运行可复现且互不重叠
+ * void       vec_rng_jump(r)               : 所有 lane 前进 2^96 步（等价于 stream + 1）
+ * vint_t     vec_rng_next_i(r)             : 每 lane 一个 32 位随机整数
+ * vfloat32_t vec_rng_uniform_f(r)          : [0, 1) 均匀分布（取高 24 位）
+ * void vec_fill_u32(r, dst, n)                          : 填充 32 位随机整数
+ * void vec_fill_uniform_f32(r, dst, n, lo, hi)          : 填充 [lo, hi) 均匀分布（要求 lo < hi）
+ * void vec_fill_normal_f32(r, dst, n, mean, stddev)     : 填充正态分布（向量化 Box-Muller）
+ *
+ * 结果只取决于种子、stream 与 VEC_WIDTH；相同后端下重复运行得到相同序列。
+ * xoshiro128+ 的最低几位线性复杂度较低，需要高质量低位时请使用高位。
+ */
+typedef struct {
+  vint_t s[4];
+} vec_rng_t;
+
+/* 标量 xoshiro128 状态推进与跳跃，仅用于初始化 */
+static inline uint32_t vec_rng_step_(uint32_t* s) {
+  uint32_t res = s[0] + s[3];
+  uint32_t t = s[1] << 9;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = (s[3] << 11) | (s[3] >> 21);
+  return res;
+}
+
+static inline void vec_rng_jump_scalar_(uint32_t* s, const uint32_t* poly) {
+  uint32_t acc[4] = {0, 0, 0, 0};
+  int i, b;
+  for (i = 0; i < 4; ++i)
+    for (b = 0; b < 32; ++b) {
+      if (poly[i] & (1u << b)) {
+        acc[0] ^= s[0]; acc[1] ^= s[1]; acc[2] ^= s[2]; acc[3] ^= s[3];
+      }
+      vec_rng_step_(s);
+    }
+  s[0] = acc[0]; s[1] = acc[1]; s[2] = acc[2]; s[3] = acc[3];
+}
+
+static const uint32_t vec_rng_jump64_[4] = {0x8764000bu, 0xf542d2d3u, 0x6fa035c3u, 0x77f2db5bu};
+static const uint32_t vec_rng_jump96_[4] = {0xb523952eu, 0x0b6f099fu, 0xccf5a0efu, 0x1c580662u};
+
+/* lane 状态 <-> 向量：state[k][j] 为 lane k 的第 j 个字 */
+static inline void vec_rng_unpack_(const vec_rng_t* r, uint32_t state[VEC_WIDTH_F][4]) {
+  int32_t tmp[VEC_WIDTH_F];
+  int j, k;
+  for (j = 0; j < 4; ++j) {
+    VEC_STOREU_I(tmp, r->s[j]);
+    for (k = 0; k < VEC_WIDTH_F; ++k) state[k][j] = (uint32_t)tmp[k];
+  }
+}
+
+static inline void vec_rng_pack_(vec_rng_t* r, uint32_t state[VEC_WIDTH_F][4]) {
+  int32_t tmp[VEC_WIDTH_F];
+  int j, k;
+  for (j = 0; j < 4; ++j) {
+    for (k = 0; k < VEC_WIDTH_F; ++k) tmp[k] = (int32_t)state[k][j];
+    r->s[j] = VEC_LOADU_I(tmp);
+  }
+}
+
+static inline void vec_rng_seed(vec_rng_t* r, uint64_t seed, uint64_t stream) {
+  uint32_t state[VEC_WIDTH_F][4];
+  uint32_t base[4];
+  uint64_t z, st;
+  int j, k;
+  /* splitmix64 展开种子，保证状态非全零 */
+  for (j = 0; j < 4; j += 2) {
+    seed += 0x9e3779b97f4a7c15ull;
+    z = seed;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    z ^= z >> 31;
+    base[j] = (uint32_t)z;
+    base[j + 1] = (uint32_t)(z >> 32);
+  }
+  for (st = 0; st < stream; ++st) vec_rng_jump_scalar_(base, vec_rng_jump96_);
+  for (k = 0; k < VEC_WIDTH_F; ++k) {
+    for (j = 0; j < 4; ++j) state[k][j] = base[j];
+    vec_rng_jump_scalar_(base, vec_rng_jump64_);
+  }
+  vec_rng_pack_(r, state);
+}
+
+static inline void vec_rng_jump(vec_rng_t* r) {
+  uint32_t state[VEC_WIDTH_F][4];
+  int k;
+  vec_rng_unpack_(r, state);
+  for (k = 0; k < VEC_WIDTH_F; ++k) vec_rng_jump_scalar_(state[k], vec_rng_jump96_);
+  vec_rng_pack_(r, state);
+}
+
+static inline vint_t vec_rng_next_i(vec_rng_t* r) {
+#if VEC_WIDTH_F > 1
+  vint_t res = VEC_ADD_I(r->s[0], r->s[3]);
+  vint_t t = VEC_SLL_I(r->s[1], 9);
+  r->s[2] = VEC_XOR_I(r->s[2], r->s[0]);
+  r->s[3] = VEC_XOR_I(r->s[3], r->s[1]);
+  r->s[1] = VEC_XOR_I(r->s[1], r->s[2]);
+  r->s[0] = VEC_XOR_I(r->s[0], r->s[3]);
+  r->s[2] = VEC_XOR_I(r->s[2], t);
+  r->s[3] = VEC_ROTL_I(r->s[3], 11);
+  return res;
+#else
+  /* 标量 int 的有符号溢出是未定义行为，按 uint32 计算 */
+  uint32_t s[4];
+  uint32_t res;
+  int j;
+  for (j = 0; j < 4; ++j) s[j] = (uint32_t)r->s[j];
+  res = vec_rng_step_(s);
+  for (j = 0; j < 4; ++j) r->s[j] = (int)s[j];
+  return (int)res;
+#endif
+}
+
+static inline vfloat32_t vec_rng_uniform_f(vec_rng_t* r) {
+  return VEC_MUL_F(VEC_I2F(VEC_SRL_I(vec_rng_next_i(r), 8)), VEC_SET1_F(1.0f / 16777216.0f));
+}
+
+/* 自然对数，x > 0（Cephes logf 多项式，相对误差约 1e-7） */
+static inline vfloat32_t vec_log_f_(vfloat32_t x) {
+  vint_t bits = VEC_CAST_F2I(x);
+  vfloat32_t e = VEC_I2F(VEC_SUB_I(VEC_SRL_I(bits, 23), VEC_SET1_I(127)));
+  vfloat32_t m = VEC_CAST_I2F(VEC_OR_I(VEC_AND_I(bits, VEC_SET1_I(0x007fffff)), VEC_SET1_I(0x3f800000)));
+  vmask_t big = VEC_CMPGT_F(m, VEC_SET1_F(1.41421356f));
+  vfloat32_t f, z, y;
+  /* 把尾数规约到 [sqrt(1/2), sqrt(2))，f = m - 1 */
+  m = VEC_SELECT(big, m, VEC_MUL_F(m, VEC_SET1_F(0.5f)));
+  e = VEC_SELECT(big, e, VEC_ADD_F(e, VEC_SET1_F(1.0f)));
+  f = VEC_SUB_F(m, VEC_SET1_F(1.0f));
+  z = VEC_MUL_F(f, f);
+  y = VEC_SET1_F(7.0376836292e-2f);
+  y = VEC_FMA_F(y, f, VEC_SET1_F(-1.1514610310e-1f));
+  y = VEC_FMA_F(y, f, VEC_SET1_F(1.1676998740e-1f));
+  y = VEC_FMA_F(y, f, VEC_SET1_F(-1.2420140846e-1f));
+  y = VEC_FMA_F(y, f, VEC_SET1_F(1.4249322787e-1f));
+  y = VEC_FMA_F(y, f, VEC_SET1_F(-1.6668057665e-1f));
+  y = VEC_FMA_F(y, f, VEC_SET1_F(2.0000714765e-1f));
+  y = VEC_FMA_F(y, f, VEC_SET1_F(-2.4999993993e-1f));
+  y = VEC_FMA_F(y, f, VEC_SET1_F(3.3333331174e-1f));
+  y = VEC_MUL_F(VEC_MUL_F(y, f), z);
+  y = VEC_FMA_F(e, VEC_SET1_F(-2.12194440e-4f), y);
+  y = VEC_FMA_F(z, VEC_SET1_F(-0.5f), y);
+  return VEC_FMA_F(e, VEC_SET1_F(0.693359375f), VEC_ADD_F(f, y));
+}
+
+/* 生成两组独立标准正态分布：z0 = r cos(theta)，z1 = r sin(theta) */
+static inline void vec_rng_normal2_(vec_rng_t* rng, vfloat32_t* z0, vfloat32_t* z1) {
+  const vfloat32_t scale = VEC_SET1_F(1.0f / 16777216.0f);
+  vint_t a = vec_rng_next_i(rng);
+  vint_t b = vec_rng_next_i(rng);
+  /* u1 取 (0, 1]，避免 log(0) */
+  vfloat32_t u1 = VEC_MUL_F(VEC_ADD_F(VEC_I2F(VEC_SRL_I(a, 8)), VEC_SET1_F(1.0f)), scale);
+  vfloat32_t r = VEC_SQRT_F(VEC_MUL_F(VEC_SET1_F(-2.0f), vec_log_f_(u1)));
+  /* 角度 = 象限 * pi/2 + phi，phi 在 [-pi/4, pi/4) 上用多项式求 sin / cos，象限取 b 的第 6、7 位 */
+  vfloat32_t phi = VEC_MUL_F(VEC_SUB_F(VEC_MUL_F(VEC_I2F(VEC_SRL_I(b, 8)), scale), VEC_SET1_F(0.5f)),
+                             VEC_SET1_F(1.57079632679f));
+  vfloat32_t zz = VEC_MUL_F(phi, phi);
+  vfloat32_t sp = VEC_FMA_F(VEC_FMA_F(VEC_SET1_F(-1.9515295891e-4f), zz, VEC_SET1_F(8.3321608736e-3f)),
+                            zz, VEC_SET1_F(-1.6666654611e-1f));
+  vfloat32_t cp = VEC_FMA_F(VEC_FMA_F(VEC_SET1_F(2.443315711809948e-5f), zz, VEC_SET1_F(-1.388731625493765e-3f)),
+                            zz, VEC_SET1_F(4.166664568298827e-2f));
+  vfloat32_t sn = VEC_FMA_F(VEC_MUL_F(phi, zz), sp, phi);
+  vfloat32_t cs = VEC_FMA_F(VEC_MUL_F(zz, zz), cp, VEC_FMA_F(zz, VEC_SET1_F(-0.5f), VEC_SET1_F(1.0f)));
+  vint_t quad = VEC_AND_I(VEC_SRL_I(b, 6), VEC_SET1_I(3));
+  vmask_t odd = VEC_CMPEQ_I(VEC_AND_I(quad, VEC_SET1_I(1)), VEC_SET1_I(1));
+  vmask_t neg = VEC_CMPEQ_I(VEC_AND_I(quad, VEC_SET1_I(2)), VEC_SET1_I(2));
+  vfloat32_t sign = VEC_SELECT(neg, VEC_SET1_F(1.0f), VEC_SET1_F(-1.0f));
+  /* 旋转 90 度：(cos, sin) -> (-sin, cos) */
+  vfloat32_t c = VEC_SELECT(odd, cs, VEC_SUB_F(VEC_SETZERO_F(), sn));
+  vfloat32_t s = VEC_SELECT(odd, sn, cs);
+  *z0 = VEC_MUL_F(VEC_MUL_F(r, sign), c);
+  *z1 = VEC_MUL_F(VEC_MUL_F(r, sign), s);
+}
+
+static inline void vec_fill_u32(vec_rng_t* r, uint32_t* dst, size_t n) {
+  int32_t tmp[VEC_WIDTH_F];
+  size_t i = 0;
+  VEC_PROF_BEGIN(vec_fill_u32);
+  for (; i + VEC_WIDTH_F <= n; i += VEC_WIDTH_F) VEC_STOREU_I(dst + i, vec_rng_next_i(r));
+  if (i < n) {
+    VEC_STOREU_I(tmp, vec_rng_next_i(r));
+    for (; i < n; ++i) dst[i] = (uint32_t)tmp[i % VEC_WIDTH_F];
+  }
+  VEC_PROF_END(vec_fill_u32, n, n * sizeof(uint32_t));
+}
+
+/* u * (hi - lo) + lo 舍入后可能恰好等于 hi（如 lo = 1, hi = 2），结果截到 hi 之前的最后一个 float */
+static inline void vec_fill_uniform_f32(vec_rng_t* r, float* dst, size_t n, float lo, float hi) {
+  vfloat32_t vlo = VEC_SET1_F(lo), vspan = VEC_SET1_F(hi - lo), vmax = VEC_SET1_F(nextafterf(hi, lo));
+  float tmp[VEC_WIDTH_F];
+  size_t i = 0;
+  VEC_PROF_BEGIN(vec_fill_uniform_f32);
+  for (; i + VEC_WIDTH_F <= n; i += VEC_WIDTH_F)
+    VEC_STOREU_F(dst + i, VEC_MIN_F(VEC_FMA_F(vec_rng_uniform_f(r), vspan, vlo), vmax));
+  if (i < n) {
+    VEC_STOREU_F(tmp, VEC_MIN_F(VEC_FMA_F(vec_rng_uniform_f(r), vspan, vlo), vmax));
+    for (; i < n; ++i) dst[i] = tmp[i % VEC_WIDTH_F];
+  }
+  VEC_PROF_END(vec_fill_uniform_f32, n, n * sizeof(float));
+}
+
+static inline void vec_fill_normal_f32(vec_rng_t* r, float* dst, size_t n, float mean, float stddev) {
+  vfloat32_t vm = VEC_SET1_F(mean), vs = VEC_SET1_F(stddev);
+  vfloat32_t z0, z1;
+  float tmp[2 * VEC_WIDTH_F];
+  size_t i = 0, k;
+  VEC_PROF_BEGIN(vec_fill_normal_f32);
+  for (; i + 2 * VEC_WIDTH_F <= n; i += 2 * VEC_WIDTH_F) {
+    vec_rng_normal2_(r, &z0, &z1);
+    VEC_STOREU_F(dst + i, VEC_FMA_F(z0, vs, vm));
+    VEC_STOREU_F(dst + i + VEC_WIDTH_F, VEC_FMA_F(z1, vs, vm));
+  }
+  if (i < n) {
+    vec_rng_normal2_(r, &z0, &z1);
+    VEC_STOREU_F(tmp, VEC_FMA_F(z0, vs, vm));
+    VEC_STOREU_F(tmp + VEC_WIDTH_F, VEC_FMA_F(z1, vs, vm));
+    for (k = 0; i < n; ++i, ++k) dst[i] = tmp[k];
+  }
+  VEC_PROF_END(vec_fill_normal_f32, n, n * sizeof(float));
+}
+
+/* ---------- 复数：交错存储（re, im, re, im, ...）的 float 复数 ---------- */
+/*
+ * 一个 vfloat32_t 容纳 VEC_WIDTH / 2 个复数。以下向量接口仅在 VEC_WIDTH >= 4 时提供：
+ *
+ *   vfloat32_t VEC_CBROADCAST_F(p)  : 读取 p[0], p[1] 一个复数并广播到所有复数 lane
+ *   vfloat32_t VEC_CSET1_F(re, im)  : 所有复数 lane 置为 re + i*im
+ *   vfloat32_t VEC_CSWAP_F(a)       : 交换每个复数的实部与虚部
+ *   vfloat32_t VEC_CONJ_F(a)        : 共轭
+ *   vfloat32_t VEC_CMUL_F(a, b)     : a * b（x86 为 moveldup/movehdup + addsub / fmaddsub，AArch64 为 vcmla）
+ *   vfloat32_t VEC_CMULCONJ_F(a, b) : a * conj(b)
+ *
+ * 数组级内核（所有后端可用，n 为复数个数）：
+ *   void vec_cmul_f32(dst, a, b, n) / vec_cmulconj_f32(dst, a, b, n)
+ *   void vec_cabs_f32(dst, src, n)  : dst[k] = |src[k]|，dst 为 n 个 float
+ */
+#define VEC_CLANES_ (VEC_WIDTH_F / 2)
+
+#if defined(VEC_IMPL_AVX512)
+  #define VEC_CBROADCAST_F(p) _mm512_castpd_ps(_mm512_broadcastsd_pd(_mm_load_sd((const double*)(const void*)(p))))
+  #define VEC_CSWAP_F(a)      _mm512_permute_ps((a), 0xB1)
+static inline vfloat32_t VEC_CMUL_F(vfloat32_t a, vfloat32_t b) {
+  return _mm512_fmaddsub_ps(_mm512_moveldup_ps(a), b, _mm512_mul_ps(_mm512_movehdup_ps(a), VEC_CSWAP_F(b)));
+}
+#elif defined(VEC_IMPL_AVX)
+  #define VEC_CBROADCAST_F(p) _mm256_castpd_ps(_mm256_broadcast_sd((const double*)(const void*)(p)))
+  #define VEC_CSWAP_F(a)      _mm256_permute_ps((a), 0xB1)
+static inline vfloat32_t VEC_CMUL_F(vfloat32_t a, vfloat32_t b) {
+  #if defined(__FMA__)
+  return _mm256_fmaddsub_ps(_mm256_moveldup_ps(a), b, _mm256_mul_ps(_mm256_movehdup_ps(a), VEC_CSWAP_F(b)));
+  #else
+  return _mm256_addsub_ps(_mm256_mul_ps(_mm256_moveldup_ps(a), b), _mm256_mul_ps(_mm256_movehdup_ps(a), VEC_CSWAP_F(b)));
+  #endif
+}
+#elif defined(VEC_IMPL_SSE)
+  #define VEC_CBROADCAST_F(p) _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(const void*)(p)), \
+                                            _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(const void*)(p)))
+  #define VEC_CSWAP_F(a)      _mm_shuffle_ps((a), (a), 0xB1)
+static inline vfloat32_t VEC_CMUL_F(vfloat32_t a, vfloat32_t b) {
+  #if defined(__SSE3__)
+  return _mm_addsub_ps(_mm_mul_ps(_mm_moveldup_ps(a), b), _mm_mul_ps(_mm_movehdup_ps(a), VEC_CSWAP_F(b)));
+  #else
+  /* 无 SSE3：用 shuffle 复制实部 / 虚部，addsub 用乘以 (-1, 1) 模拟 */
+  __m128 re = _mm_shuffle_ps(a, a, 0xA0), im = _mm_shuffle_ps(a, a, 0xF5);
+  return _mm_add_ps(_mm_mul_ps(re, b),
+                    _mm_mul_ps(_mm_mul_ps(im, VEC_CSWAP_F(b)), _mm_setr_ps(-1.0f, 1.0f, -1.0f, 1.0f)));
+  #endif
+}
+#elif defined(VEC_IMPL_NEON)
+  #define VEC_CBROADCAST_F(p) vcombine_f32(vld1_f32((const float*)(p)), vld1_f32((const float*)(p)))
+  #define VEC_CSWAP_F(a)      vrev64q_f32(a)
+static inline vfloat32_t VEC_CMUL_F(vfloat32_t a, vfloat32_t b) {
+  #if defined(__aarch64__) && defined(__ARM_FEATURE_COMPLEX)
+  return vcmlaq_rot90_f32(vcmlaq_f32(vdupq_n_f32(0.0f), a, b), a, b);
+  #else
+  static const float sign[4] = {-1.0f, 1.0f, -1.0f, 1.0f};
+  float32x4x2_t t = vtrnq_f32(a, a);  /* val[0] = 实部复制，val[1] = 虚部复制 */
+  return VEC_FMA_F(t.val[0], b, vmulq_f32(vmulq_f32(t.val[1], vrev64q_f32(b)), vld1q_f32(sign)));
+  #endif
+}
+#endif
+
+#if VEC_WIDTH_F >= 4
+static inline vfloat32_t VEC_CSET1_F(float re, float im) {
+  float t[2];
+  t[0] = re;
+  t[1] = im;
+  return VEC_CBROADCAST_F(t);
+}
+  #define VEC_CONJ_F(a)        VEC_MUL_F((a), VEC_CSET1_F(1.0f, -1.0f))
+  #define VEC_CMULCONJ_F(a,b)  VEC_CMUL_F((a), VEC_CONJ_F(b))
+  /* j * a = (-im, re) */
+  #define VEC_CMULJ_(a)        VEC_MUL_F(VEC_CSWAP_F(a), VEC_CSET1_F(-1.0f, 1.0f))
+
+/* 取两个向量的偶数 lane 并拼接：[u0 u2 u4 ... v0 v2 v4 ...] */
+static inline vfloat32_t vec_even2_f_(vfloat32_t u, vfloat32_t v) {
+  #if defined(VEC_IMPL_AVX512)
+  return _mm512_permutex2var_ps(u, _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14,
+                                                     16, 18, 20, 22, 24, 26, 28, 30), v);
+  #elif defined(VEC_IMPL_AVX)
+  return _mm256_shuffle_ps(_mm256_permute2f128_ps(u, v, 0x20), _mm256_permute2f128_ps(u, v, 0x31), 0x88);
+  #elif defined(VEC_IMPL_SSE)
+  return _mm_shuffle_ps(u, v, 0x88);
+  #else
+  return vuzpq_f32(u, v).val[0];
+  #endif
+}
+#endif
+
+static inline void vec_cmul_f32(float* dst, const float* a, const float* b, size_t n) {
+  size_t i = 0;
+  VEC_PROF_BEGIN(vec_cmul_f32);
+#if VEC_WIDTH_F >= 4
+  for (; i + VEC_CLANES_ <= n; i += VEC_CLANES_)
+    VEC_STOREU_F(dst + 2 * i, VEC_CMUL_F(VEC_LOADU_F(a + 2 * i), VEC_LOADU_F(b + 2 * i)));
+#endif
+  for (; i < n; ++i) {
+    float re = a[2 * i] * b[2 * i] - a[2 * i + 1] * b[2 * i + 1];
+    float im = a[2 * i] * b[2 * i + 1] + a[2 * i + 1] * b[2 * i];
+    dst[2 * i] = re;
+    dst[2 * i + 1] = im;
+  }
+  VEC_PROF_END(vec_cmul_f32, n, 6 * n * sizeof(float));
+}
+
+static inline void vec_cmulconj_f32(float* dst, const float* a, const float* b, size_t n) {
+  size_t i = 0;
+  VEC_PROF_BEGIN(vec_cmulconj_f32);
+#if VEC_WIDTH_F >= 4
+  for (; i + VEC_CLANES_ <= n; i += VEC_CLANES_)
+    VEC_STOREU_F(dst + 2 * i, VEC_CMULCONJ_F(VEC_LOADU_F(a + 2 * i), VEC_LOADU_F(b + 2 * i)));
+#endif
+  for (; i < n; ++i) {
+    float re = a[2 * i] * b[2 * i] + a[2 * i + 1] * b[2 * i + 1];
+    float im = a[2 * i + 1] * b[2 * i] - a[2 * i] * b[2 * i + 1];
+    dst[2 * i] = re;
+    dst[2 * i + 1] = im;
+  }
+  VEC_PROF_END(vec_cmulconj_f32, n, 6 * n * sizeof(float));
+}
+
+static inline void vec_cabs_f32(float* dst, const float* src, size_t n) {
+  size_t i = 0;
+  VEC_PROF_BEGIN(vec_cabs_f32);
+#if VEC_WIDTH_F >= 4
+  /* 每轮两个向量共 VEC_WIDTH 个复数：平方后与交换结果相加，得到成对重复的 |z|^2，再取偶数 lane */
+  for (; i + VEC_WIDTH_F <= n; i += VEC_WIDTH_F) {
+    vfloat32_t u = VEC_LOADU_F(src + 2 * i);
+    vfloat32_t v = VEC_LOADU_F(src + 2 * i + VEC_WIDTH_F);
+    u = VEC_MUL_F(u, u);
+    v = VEC_MUL_F(v, v);
+    u = VEC_ADD_F(u, VEC_CSWAP_F(u));
+    v = VEC_ADD_F(v, VEC_CSWAP_F(v));
+    VEC_STOREU_F(dst + i, VEC_SQRT_F(vec_even2_f_(u, v)));
+  }
+#endif
+  for (; i < n; ++i) dst[i] = sqrtf(src[2 * i] * src[2 * i] + src[2 * i + 1] * src[2 * i + 1]);
+  VEC_PROF_END(vec_cabs_f32, n, 3 * n * sizeof(float));
+}
+
+/* ---------- FFT：Stockham 自动排序 radix-4（对数为奇数时最后补一级 radix-2） ---------- */
+/*
+ * 长度须为 2 的幂。计划（plan）预先计算所有旋转因子，可在多次调用间复用；
+ * 计划内含工作区，同一计划不能被多个线程同时使用。
+ *
+ *   int  vec_fft_plan_init(plan, n)       : n 点复数 FFT 计划；成功返回 0，长度非法或内存不足返回 -1
+ *   int  vec_fft_plan_init_real(plan, n)  : n 点实数 FFT 计划（n >= 2）
+ *   void vec_fft_plan_free(plan)
+ *   void vec_fft_c2c(plan, in, out, dir)  : 交错复数，dir 为 VEC_FFT_FORWARD / VEC_FFT_INVERSE；in 可以等于 out
+ *   int  vec_fft_r2c(plan, in, out)       : n 个实数 -> n/2 + 1 个复数（交错存储）
+ *   int  vec_fft_c2r(plan, in, out)       : n/2 + 1 个复数 -> n 个实数
+ * r2c / c2r 只接受 vec_fft_plan_init_real 建立的计划，成功返回 0；传入复数计划时返回 -1，不写 out。
+ * 变换会写计划内的工作区，因此计划参数不带 const。
+ * 正变换为 X[k] = sum x[j] e^{-2 pi i jk/n}；逆变换含 1/n 缩放，正逆变换往返得到原数据。
+ *
+ * 每一级中步长 s >= VEC_WIDTH/2 时沿 q 方向整向量计算，旋转因子按 p 广播；
+ * 步长更小的前一两级沿展平下标计算，使用按下标展开的旋转因子表，结果再按 Stockham 顺序写出。
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#define VEC_FFT_FORWARD 0
+#define VEC_FFT_INVERSE 1
+
+typedef struct {
+  size_t n;       /* 内部复数 FFT 长度 */
+  size_t n_real;  /* 实数 FFT 长度（= 2n）；复数计划为 0 */
+  float* tw;      /* 每级 radix-4 的 w^p, w^2p, w^3p，按级依次存放 */
+  float* twx;     /* 小步长级按展平下标展开的旋转因子 */
+  float* rtw;     /* 实数 FFT 前 / 后处理的 e^{-2 pi i k / n_real}，k < n/2 + 1 */
+  float* work;    /* 2n 个 float 的乒乓缓冲 */
+} vec_fft_plan_t;
+
+static inline void vec_fft_plan_free(vec_fft_plan_t* plan) {
+  free(plan->tw);
+  free(plan->twx);
+  free(plan->rtw);
+  free(plan->work);
+  memset(plan, 0, sizeof(*plan));
+}
+
+static inline int vec_fft_plan_init(vec_fft_plan_t* plan, size_t n) {
+  const double two_pi = 6.28318530717958647692;
+  size_t len, s, p, j, ntw = 0, ntwx = 0, off = 0, offx = 0;
+  int k;
+  memset(plan, 0, sizeof(*plan));
+  if (n == 0 || (n & (n - 1)) != 0) return -1;
+  for (len = n, s = 1; len >= 4; len /= 4, s *= 4) {
+    ntw += (len / 4) * 6;
+#if VEC_WIDTH_F >= 4
+    if (s < VEC_CLANES_ && n / 4 >= VEC_CLANES_) ntwx += (n / 4) * 6;
+#endif
+  }
+  plan->n = n;
+  plan->tw = (float*)malloc((ntw + 1) * sizeof(float));
+  plan->twx = (float*)malloc((ntwx + 1) * sizeof(float));
+  plan->work = (float*)malloc(2 * n * sizeof(float));
+  if (!plan->tw || !plan->twx || !plan->work) {
+    vec_fft_plan_free(plan);
+    return -1;
+  }
+  for (len = n, s = 1; len >= 4; len /= 4, s *= 4) {
+    size_t n1 = len / 4;
+    for (p = 0; p < n1; ++p)
+      for (k = 1; k <= 3; ++k) {
+        double a = -two_pi * (double)(k * p) / (double)len;
+        plan->tw[off + 6 * p + 2 * (k - 1)] = (float)cos(a);
+        plan->tw[off + 6 * p + 2 * (k - 1) + 1] = (float)sin(a);
+      }
+#if VEC_WIDTH_F >= 4
+    if (s < VEC_CLANES_ && n / 4 >= VEC_CLANES_) {
+      /* 三段，每段 n/4 个复数：twx[k-1 段][j] = w^{k * (j / s)} */
+      for (j = 0; j < n / 4; ++j)
+        for (k = 0; k < 3; ++k) {
+          plan->twx[offx + k * (n / 2) + 2 * j] = plan->tw[off + 6 * (j / s) + 2 * k];
+          plan->twx[offx + k * (n / 2) + 2 * j + 1] = plan->tw[off + 6 * (j / s) + 2 * k + 1];
+        }
+      offx += (n / 4) * 6;
+    }
+#else
+    (void)j;
+    (void)offx;
+#endif
+    off += n1 * 6;
+  }
+  return 0;
+}
+
+static inline int vec_fft_plan_init_real(vec_fft_plan_t* plan, size_t n) {
+  const double two_pi = 6.28318530717958647692;
+  size_t k;
+  if (n < 2 || vec_fft_plan_init(plan, n / 2) != 0) return -1;
+  plan->n_real = n;
+  plan->rtw = (float*)malloc((n / 2 + 1) * 2 * sizeof(float));
+  if (!plan->rtw) {
+    vec_fft_plan_free(plan);
+    return -1;
+  }
+  for (k = 0; k <= n / 2; ++k) {
+    double a = -two_pi * (double)k / (double)n;
+    plan->rtw[2 * k] = (float)cos(a);
+    plan->rtw[2 * k + 1] = (float)sin(a);
+  }
+  return 0;
+}
+
+#if VEC_WIDTH_F >= 4
+/* radix-4 蝶形：y0 = (a+c)+(b+d)，y1 = w1((a-c)-j(b-d))，y2 = w2((a+c)-(b+d))，y3 = w3((a-c)+j(b-d)) */
+VEC_FORCE_INLINE_ void vec_fft_bfly4_(vfloat32_t a, vfloat32_t b, vfloat32_t c, vfloat32_t d,
+                                      vfloat32_t w1, vfloat32_t w2, vfloat32_t w3, vfloat32_t* y) {
+  vfloat32_t apc = VEC_ADD_F(a, c), amc = VEC_SUB_F(a, c);
+  vfloat32_t bpd = VEC_ADD_F(b, d), jbmd = VEC_CMULJ_(VEC_SUB_F(b, d));
+  y[0] = VEC_ADD_F(apc, bpd);
+  y[1] = VEC_CMUL_F(w1, VEC_SUB_F(amc, jbmd));
+  y[2] = VEC_CMUL_F(w2, VEC_SUB_F(apc, bpd));
+  y[3] = VEC_CMUL_F(w3, VEC_ADD_F(amc, jbmd));
+}
+#endif
+
+/* 标量 radix-4 蝶形，x / y 指向 a 与输出的第一个元素，xs / ys 为四个输入 / 输出之间的 float 间距 */
+static inline void vec_fft_bfly4_scalar_(const float* x, size_t xs, float* y, size_t ys, const float* w) {
+  float ar = x[0], ai = x[1], br = x[xs], bi = x[xs + 1];
+  float cr = x[2 * xs], ci = x[2 * xs + 1], dr = x[3 * xs], di = x[3 * xs + 1];
+  float apcr = ar + cr, apci = ai + ci, amcr = ar - cr, amci = ai - ci;
+  float bpdr = br + dr, bpdi = bi + di, jbmdr = di - bi, jbmdi = br - dr;
+  float t1r = amcr - jbmdr, t1i = amci - jbmdi;
+  float t2r = apcr - bpdr, t2i = apci - bpdi;
+  float t3r = amcr + jbmdr, t3i = amci + jbmdi;
+  y[0] = apcr + bpdr;
+  y[1] = apci + bpdi;
+  y[ys] = w[0] * t1r - w[1] * t1i;
+  y[ys + 1] = w[0] * t1i + w[1] * t1r;
+  y[2 * ys] = w[2] * t2r - w[3] * t2i;
+  y[2 * ys + 1] = w[2] * t2i + w[3] * t2r;
+  y[3 * ys] = w[4] * t3r - w[5] * t3i;
+  y[3 * ys + 1] = w[4] * t3i + w[5] * t3r;
+}
+
+/* 原地正变换 data[0..2n) */
+static inline void vec_fft_forward_(vec_fft_plan_t* plan, float* data) {
+  const size_t n = plan->n, q4 = n / 4;
+  size_t len, s, p, q, off = 0;
+#if VEC_WIDTH_F >= 4
+  size_t offx = 0;
+#endif
+  float* x = data;
+  float* y = plan->work;
+  float* t;
+  for (len = n, s = 1; len >= 4; len /= 4, s *= 4) {
+    const size_t n1 = len / 4;  /* s * n1 == q4 */
+    const float* tw = plan->tw + off;
+#if VEC_WIDTH_F >= 4
+    if (s >= VEC_CLANES_) {
+      vfloat32_t v[4];
+      for (p = 0; p < n1; ++p) {
+        vfloat32_t w1 = VEC_CBROADCAST_F(tw + 6 * p);
+        vfloat32_t w2 = VEC_CBROADCAST_F(tw + 6 * p + 2);
+        vfloat32_t w3 = VEC_CBROADCAST_F(tw + 6 * p + 4);
+        for (q = 0; q < s; q += VEC_CLANES_) {
+          const float* xp = x + 2 * (q + s * p);
+          float* yp = y + 2 * (q + 4 * s * p);
+          vec_fft_bfly4_(VEC_LOADU_F(xp), VEC_LOADU_F(xp + 2 * q4), VEC_LOADU_F(xp + 4 * q4),
+                         VEC_LOADU_F(xp + 6 * q4), w1, w2, w3, v);
+          VEC_STOREU_F(yp, v[0]);
+          VEC_STOREU_F(yp + 2 * s, v[1]);
+          VEC_STOREU_F(yp + 4 * s, v[2]);
+          VEC_STOREU_F(yp + 6 * s, v[3]);
+        }
+      }
+    } else if (q4 >= VEC_CLANES_) {
+      const float* twx = plan->twx + offx;
+      float tmp[4][VEC_WIDTH_F];
+      vfloat32_t v[4];
+      size_t j, l;
+      int k;
+      for (j = 0; j < q4; j += VEC_CLANES_) {
+        vec_fft_bfly4_(VEC_LOADU_F(x + 2 * j), VEC_LOADU_F(x + 2 * (j + q4)),
+                       VEC_LOADU_F(x + 2 * (j + 2 * q4)), VEC_LOADU_F(x + 2 * (j + 3 * q4)),
+                       VEC_LOADU_F(twx + 2 * j), VEC_LOADU_F(twx + n / 2 + 2 * j),
+                       VEC_LOADU_F(twx + n + 2 * j), v);
+        for (k = 0; k < 4; ++k) VEC_STOREU_F(tmp[k], v[k]);
+        /* 展平下标 j + l = q + s * p，写到 y[q + s * (4p + k)] */
+        for (l = 0; l < VEC_CLANES_; ++l) {
+          size_t jj = j + l;
+          float* yp = y + 2 * (jj % s + 4 * s * (jj / s));
+          for (k = 0; k < 4; ++k) {
+            yp[2 * s * (size_t)k] = tmp[k][2 * l];
+            yp[2 * s * (size_t)k + 1] = tmp[k][2 * l + 1];
+          }
+        }
+      }
+      offx += q4 * 6;
+    } else
+#endif
+    {
+      for (p = 0; p < n1; ++p)
+        for (q = 0; q < s; ++q)
+          vec_fft_bfly4_scalar_(x + 2 * (q + s * p), 2 * q4, y + 2 * (q + 4 * s * p), 2 * s, tw + 6 * p);
+    }
+    off += n1 * 6;
+    t = x; x = y; y = t;
+  }
+  if (len == 2) {
+    /* 最后一级 radix-2：s = n / 2，旋转因子均为 1 */
+    q = 0;
+#if VEC_WIDTH_F >= 4
+    for (; q + VEC_CLANES_ <= s; q += VEC_CLANES_) {
+      vfloat32_t a = VEC_LOADU_F(x + 2 * q), b = VEC_LOADU_F(x + 2 * (q + s));
+      VEC_STOREU_F(y + 2 * q, VEC_ADD_F(a, b));
+      VEC_STOREU_F(y + 2 * (q + s), VEC_SUB_F(a, b));
+    }
+#endif
+    for (; q < s; ++q) {
+      float ar = x[2 * q], ai = x[2 * q + 1], br = x[2 * (q + s)], bi = x[2 * (q + s) + 1];
+      y[2 * q] = ar + br;
+      y[2 * q + 1] = ai + bi;
+      y[2 * (q + s)] = ar - br;
+      y[2 * (q + s) + 1] = ai - bi;
+    }
+    t = x; x = y; y = t;
+  }
+  if (x != data) memcpy(data, x, 2 * n * sizeof(float));
+}
+
+/* data[i] *= (re, im)（按复数 lane 交错的两个实数系数），用于共轭与缩放 */
+static inline void vec_fft_scale_pairs_(float* data, size_t n, float re, float im) {
+  size_t i = 0;
+#if VEC_WIDTH_F >= 4
+  vfloat32_t f = VEC_CSET1_F(re, im);
+  for (; i + VEC_CLANES_ <= n; i += VEC_CLANES_)
+    VEC_STOREU_F(data + 2 * i, VEC_MUL_F(VEC_LOADU_F(data + 2 * i), f));
+#endif
+  for (; i < n; ++i) {
+    data[2 * i] *= re;
+    data[2 * i + 1] *= im;
+  }
+}
+
+static inline void vec_fft_c2c(vec_fft_plan_t* plan, const float* in, float* out, int dir) {
+  const size_t n = plan->n;
+  VEC_PROF_BEGIN(vec_fft_c2c);
+  if (in != out) memcpy(out, in, 2 * n * sizeof(float));
+  if (dir == VEC_FFT_INVERSE) {
+    /* ifft(x) = conj(fft(conj(x))) / n */
+    vec_fft_scale_pairs_(out, n, 1.0f, -1.0f);
+    vec_fft_forward_(plan, out);
+    vec_fft_scale_pairs_(out, n, 1.0f / (float)n, -1.0f / (float)n);
+  } else {
+    vec_fft_forward_(plan, out);
+  }
+  VEC_PROF_END(vec_fft_c2c, n, 4 * n * sizeof(float));
+}
+
+/* 实数 FFT：把 n 个实数视作 n/2 个复数 z[k] = x[2k] + i x[2k+1] 做复数 FFT，
+ * 再由 E = (Z[k] + conj(Z[m-k])) / 2、O = (Z[k] - conj(Z[m-k])) / 2i 得到 X[k] = E + W^k O。 */
+static inline int vec_fft_r2c(vec_fft_plan_t* plan, const float* in, float* out) {
+  const size_t m = plan->n;
+  const float* w = plan->rtw;
+  size_t k;
+  if (plan->n_real == 0 || w == NULL) return -1;
+  VEC_PROF_BEGIN(vec_fft_r2c);
+  if (in != out) memcpy(out, in, 2 * m * sizeof(float));
+  vec_fft_forward_(plan, out);
+  {
+    float z0r = out[0], z0i = out[1];
+    out[0] = z0r + z0i;
+    out[1] = 0.0f;
+    out[2 * m] = z0r - z0i;
+    out[2 * m + 1] = 0.0f;
+  }
+  for (k = 1; 2 * k <= m; ++k) {
+    size_t r = m - k;
+    float zkr = out[2 * k], zki = out[2 * k + 1], zrr = out[2 * r], zri = out[2 * r + 1];
+    /* 第 k 项 */
+    float er = 0.5f * (zkr + zrr), ei = 0.5f * (zki - zri);
+    float or_ = 0.5f * (zki + zri), oi = -0.5f * (zkr - zrr);
+    float wr = w[2 * k], wi = w[2 * k + 1];
+    out[2 * k] = er + wr * or_ - wi * oi;
+    out[2 * k + 1] = ei + wr * oi + wi * or_;
+    if (r != k) {
+      /* 第 m-k 项：E、O 取共轭，W^{m-k} = -conj(W^k) */
+      out[2 * r] = er - wr * or_ + wi * oi;
+      out[2 * r + 1] = -ei + wr * oi + wi * or_;
+    }
+  }
+  VEC_PROF_END(vec_fft_r2c, 2 * m, 4 * m * sizeof(float));
+  return 0;
+}
+
+static inline int vec_fft_c2r(vec_fft_plan_t* plan, const float* in, float* out) {
+  const size_t m = plan->n;
+  const float* w = plan->rtw;
+  size_t k;
+  if (plan->n_real == 0 || w == NULL) return -1;
+  VEC_PROF_BEGIN(vec_fft_c2r);
+  /* 由 X 还原 Z[k] = E + iO：E = (X[k] + conj(X[m-k])) / 2，O = (X[k] - conj(X[m-k])) / 2 * conj(W^k) */
+  for (k = 0; 2 * k <= m; ++k) {
+    size_t r = m - k;
+    float xkr = in[2 * k], xki = in[2 * k + 1], xrr = in[2 * r], xri = in[2 * r + 1];
+    float er = 0.5f * (xkr + xrr), ei = 0.5f * (xki - xri);
+    float dr = 0.5f * (xkr - xrr), di = 0.5f * (xki + xri);
+    float wr = w[2 * k], wi = -w[2 * k + 1];
+    float or_ = dr * wr - di * wi, oi = dr * wi + di * wr;
+    if (k == 0) {
+      out[0] = er - oi;
+      out[1] = ei + or_;
+    } else {
+      out[2 * k] = er - oi;
+      out[2 * k + 1] = ei + or_;
+      if (r != k) {
+        /* Z[m-k] = conj(E) + i conj(O) */
+        out[2 * r] = er + oi;
+        out[2 * r + 1] = -ei + or_;
+      }
+    }
+  }
+  vec_fft_c2c(plan, out, out, VEC_FFT_INVERSE);
+  VEC_PROF_END(vec_fft_c2r, 2 * m, 4 * m * sizeof(float));
+  return 0;
+}
+
+/* ---------- 位图：按 64 位字的 AND / OR / ANDNOT 与置位计数 ---------- */
+/*
+ *   uint64_t vec_bitmap_popcount(a, nwords)       : a 的置位总数
+ *   uint64_t vec_bitmap_and(dst, a, b, nwords)    : dst = a & b，返回结果的置位总数
+ *   uint64_t vec_bitmap_or(dst, a, b, nwords)     : dst = a | b
+ *   uint64_t vec_bitmap_andnot(dst, a, b, nwords) : dst = a & ~b
+ * dst 为 NULL 时只计数（如求交集基数），dst 也可以与 a 或 b 相同。
+ * 计数方式：AVX-512 VPOPCNTDQ 为 vpopcntq；AVX-512BW / AVX2 / SSSE3 为 vpshufb 半字节查表 + psadbw；
+ * SSE2 为字节内 SWAR + psadbw；NEON 为 vcnt + 逐级成对累加。
+ */
+#if defined(VEC_IMPL_AVX512) && (defined(__AVX512VPOPCNTDQ__) || defined(__AVX512BW__))
+  typedef __m512i vec_bm_t_;
+  typedef __m512i vec_bm_acc_t_;
+  #define VEC_BM_WORDS_ 8
+  #define VEC_BM_LOADU_(p)    _mm512_loadu_si512((const void*)(p))
+  #define VEC_BM_STOREU_(p,v) _mm512_storeu_si512((void*)(p),(v))
+  #define VEC_BM_AND_(a,b)    _mm512_and_si512((a),(b))
+  #define VEC_BM_OR_(a,b)     _mm512_or_si512((a),(b))
+  #define VEC_BM_ANDNOT_(a,b) _mm512_andnot_si512((b),(a))
+  #define VEC_BM_ZERO_()      _mm512_setzero_si512()
+  #define VEC_BM_REDUCE_(s)   ((uint64_t)_mm512_reduce_add_epi64(s))
+  #if defined(__AVX512VPOPCNTDQ__)
+    #define VEC_BM_ACC_(s,v)  _mm512_add_epi64((s), _mm512_popcnt_epi64(v))
+  #else
+static inline __m512i vec_bm_acc_(__m512i s, __m512i v) {
+  const __m512i lut = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+  const __m512i low = _mm512_set1_epi8(0x0F);
+  __m512i c = _mm512_add_epi8(_mm512_shuffle_epi8(lut, _mm512_and_si512(v, low)),
+                              _mm512_shuffle_epi8(lut, _mm512_and_si512(_mm512_srli_epi16(v, 4), low)));
+  return _mm512_add_epi64(s, _mm512_sad_epu8(c, _mm512_setzero_si512()));
+}
+    #define VEC_BM_ACC_(s,v)  vec_bm_acc_((s),(v))
+  #endif
+#elif defined(__AVX2__)
+  typedef __m256i vec_bm_t_;
+  typedef __m256i vec_bm_acc_t_;
+  #define VEC_BM_WORDS_ 4
+  #define VEC_BM_LOADU_(p)    _mm256_loadu_si256((const __m256i*)(p))
+  #define VEC_BM_STOREU_(p,v) _mm256_storeu_si256((__m256i*)(p),(v))
+  #define VEC_BM_AND_(a,b)    _mm256_and_si256((a),(b))
+  #define VEC_BM_OR_(a,b)     _mm256_or_si256((a),(b))
+  #define VEC_BM_ANDNOT_(a,b) _mm256_andnot_si256((b),(a))
+  #define VEC_BM_ZERO_()      _mm256_setzero_si256()
+static inline __m256i vec_bm_acc_(__m256i s, __m256i v) {
+  const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                       0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low = _mm256_set1_epi8(0x0F);
+  __m256i c = _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(v, low)),
+                              _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+  return _mm256_add_epi64(s, _mm256_sad_epu8(c, _mm256_setzero_si256()));
+}
+static inline uint64_t vec_bm_reduce_(__m256i s) {
+  uint64_t t[2];
+  _mm_storeu_si128((__m128i*)t, _mm_add_epi64(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1)));
+  return t[0] + t[1];
+}
+  #define VEC_BM_ACC_(s,v)    vec_bm_acc_((s),(v))
+  #define VEC_BM_REDUCE_(s)   vec_bm_reduce_(s)
+#elif (defined(VEC_IMPL_SSE) || defined(VEC_IMPL_AVX)) && defined(__SSE2__)
+  typedef __m128i vec_bm_t_;
+  typedef __m128i vec_bm_acc_t_;
+  #define VEC_BM_WORDS_ 2
+  #define VEC_BM_LOADU_(p)    _mm_loadu_si128((const __m128i*)(p))
+  #define VEC_BM_STOREU_(p,v) _mm_storeu_si128((__m128i*)(p),(v))
+  #define VEC_BM_AND_(a,b)    _mm_and_si128((a),(b))
+  #define VEC_BM_OR_(a,b)     _mm_or_si128((a),(b))
+  #define VEC_BM_ANDNOT_(a,b) _mm_andnot_si128((b),(a))
+  #define VEC_BM_ZERO_()      _mm_setzero_si128()
+static inline __m128i vec_bm_acc_(__m128i s, __m128i v) {
+  #if defined(__SSSE3__)
+  const __m128i lut = _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m128i low = _mm_set1_epi8(0x0F);
+  __m128i c = _mm_add_epi8(_mm_shuffle_epi8(lut, _mm_and_si128(v, low)),
+                           _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), low)));
+  #else
+  __m128i c = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi16(v, 1), _mm_set1_epi8(0x55)));
+  c = _mm_add_epi8(_mm_and_si128(c, _mm_set1_epi8(0x33)), _mm_and_si128(_mm_srli_epi16(c, 2), _mm_set1_epi8(0x33)));
+  c = _mm_and_si128(_mm_add_epi8(c, _mm_srli_epi16(c, 4)), _mm_set1_epi8(0x0F));
+  #endif
+  return _mm_add_epi64(s, _mm_sad_epu8(c, _mm_setzero_si128()));
+}
+static inline uint64_t vec_bm_reduce_(__m128i s) {
+  uint64_t t[2];
+  _mm_storeu_si128((__m128i*)t, s);
+  return t[0] + t[1];
+}
+  #define VEC_BM_ACC_(s,v)    vec_bm_acc_((s),(v))
+  #define VEC_BM_REDUCE_(s)   vec_bm_reduce_(s)
+#elif defined(VEC_IMPL_NEON)
+  typedef uint8x16_t vec_bm_t_;
+  typedef uint64x2_t vec_bm_acc_t_;
+  #define VEC_BM_WORDS_ 2
+  #define VEC_BM_LOADU_(p)    vld1q_u8((const uint8_t*)(p))
+  #define VEC_BM_STOREU_(p,v) vst1q_u8((uint8_t*)(p),(v))
+  #define VEC_BM_AND_(a,b)    vandq_u8((a),(b))
+  #define VEC_BM_OR_(a,b)     vorrq_u8((a),(b))
+  #define VEC_BM_ANDNOT_(a,b) vbicq_u8((a),(b))
+  #define VEC_BM_ZERO_()      vdupq_n_u64(0)
+  #define VEC_BM_ACC_(s,v)    vpadalq_u32((s), vpaddlq_u16(vpaddlq_u8(vcntq_u8(v))))
+  #define VEC_BM_REDUCE_(s)   (vgetq_lane_u64((s), 0) + vgetq_lane_u64((s), 1))
+#endif
+
+/* op：0 AND，1 OR，2 ANDNOT，3 仅计数 a；以常量调用，分支在内联后消失 */
+VEC_FORCE_INLINE_ uint64_t vec_bitmap_op_(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t n, int op) {
+  uint64_t total = 0;
+  size_t i = 0;
+#if defined(VEC_BM_WORDS_)
+  vec_bm_acc_t_ acc = VEC_BM_ZERO_();
+  for (; i + VEC_BM_WORDS_ <= n; i += VEC_BM_WORDS_) {
+    vec_bm_t_ v = VEC_BM_LOADU_(a + i);
+    if (op == 0) v = VEC_BM_AND_(v, VEC_BM_LOADU_(b + i));
+    if (op == 1) v = VEC_BM_OR_(v, VEC_BM_LOADU_(b + i));
+    if (op == 2) v = VEC_BM_ANDNOT_(v, VEC_BM_LOADU_(b + i));
+    if (op != 3 && dst) VEC_BM_STOREU_(dst + i, v);
+    acc = VEC_BM_ACC_(acc, v);
+  }
+  total = VEC_BM_REDUCE_(acc);
+#endif
+  for (; i < n; ++i) {
+    uint64_t w = a[i];
+    if (op == 0) w &= b[i];
+    if (op == 1) w |= b[i];
+    if (op == 2) w &= ~b[i];
+    if (op != 3 && dst) dst[i] = w;
+    total += (uint64_t)VEC_POPCOUNT64_(w);
+  }
+  return total;
+}
+
+static inline uint64_t vec_bitmap_popcount(const uint64_t* a, size_t nwords) {
+  uint64_t r;
+  VEC_PROF_BEGIN(vec_bitmap_popcount);
+  r = vec_bitmap_op_(NULL, a, NULL, nwords, 3);
+  VEC_PROF_END(vec_bitmap_popcount, nwords, nwords * sizeof(uint64_t));
+  return r;
+}
+
+static inline uint64_t vec_bitmap_and(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t nwords) {
+  uint64_t r;
+  VEC_PROF_BEGIN(vec_bitmap_and);
+  r = vec_bitmap_op_(dst, a, b, nwords, 0);
+  VEC_PROF_END(vec_bitmap_and, nwords, (dst ? 3 : 2) * nwords * sizeof(uint64_t));
+  return r;
+}
+
+static inline uint64_t vec_bitmap_or(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t nwords) {
+  uint64_t r;
+  VEC_PROF_BEGIN(vec_bitmap_or);
+  r = vec_bitmap_op_(dst, a, b, nwords, 1);
+  VEC_PROF_END(vec_bitmap_or, nwords, (dst ? 3 : 2) * nwords * sizeof(uint64_t));
+  return r;
+}
+
+static inline uint64_t vec_bitmap_andnot(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t nwords) {
+  uint64_t r;
+  VEC_PROF_BEGIN(vec_bitmap_andnot);
+  r = vec_bitmap_op_(dst, a, b, nwords, 2);
+  VEC_PROF_END(vec_bitmap_andnot, nwords, (dst ? 3 : 2) * nwords * sizeof(uint64_t));
+  return r;
+}
+
+/* ---------- int8 量化 / 反量化与 int8 点积 ---------- */
+/*
+ * 量化：q = sat(round(x * (1 / scale)) + zero_point)，舍入为最近偶数（VEC_F2I_RN），
+ *       再用 pack 指令饱和到 [-128, 127]（i8）或 [0, 255]（u8）。
+ * 反量化：x = (q - zero_point) * scale。
+ *
+ *   void vec_quantize_f32_to_i8(dst, src, n, scale, zero_point) / vec_quantize_f32_to_u8(...)
+ *   void vec_dequantize_i8_to_f32(dst, src, n, scale, zero_point) / vec_dequantize_u8_to_f32(...)
+ *   以上各有 _per_channel 版本：(dst, src, rows, channels, const float* scale, const int32_t* zero_point)，
+ *   数据按 [rows][channels] 行主序存放，scale / zero_point 各有 channels 个。
+ *
+ *   int32_t vec_dot_i8(a, b, n)   : sum(a[i] * b[i])，int8 x int8
+ *   int32_t vec_dot_u8i8(a, b, n) : uint8 x int8（激活 u8、权重 i8）
+ * 点积：AVX-512 VNNI 为 vpdpbusd（i8 x i8 时 a 加 128 后减去 128 * sum(b)）；NEON 为 sdot / usdot（需相应扩展）；
+ * 其余后端符号 / 零扩展到 int16 后用 pmaddwd / vmlal 累加。结果为精确值，累加在 int32 中进行，
+ * n 很大（最坏情况约 13 万个元素以上）时会回绕。
+ */
+
+#if VEC_WIDTH_F > 1
+/* 4 个 int32 向量饱和窄化为 4 * VEC_WIDTH 个字节写到 dst；u8 非 0 时为无符号饱和 */
+VEC_FORCE_INLINE_ void vec_q8_pack4_(void* dst, vint_t a, vint_t b, vint_t c, vint_t d, int u8) {
+  #if defined(VEC_IMPL_AVX512)
+  if (u8) {
+    const __m512i z = _mm512_setzero_si512();
+    a = _mm512_max_epi32(a, z);
+    b = _mm512_max_epi32(b, z);
+    c = _mm512_max_epi32(c, z);
+    d = _mm512_max_epi32(d, z);
+    _mm_storeu_si128((__m128i*)dst, _mm512_cvtusepi32_epi8(a));
+    _mm_storeu_si128((__m128i*)dst + 1, _mm512_cvtusepi32_epi8(b));
+    _mm_storeu_si128((__m128i*)dst + 2, _mm512_cvtusepi32_epi8(c));
+    _mm_storeu_si128((__m128i*)dst + 3, _mm512_cvtusepi32_epi8(d));
+  } else {
+    _mm_storeu_si128((__m128i*)dst, _mm512_cvtsepi32_epi8(a));
+    _mm_storeu_si128((__m128i*)dst + 1, _mm512_cvtsepi32_epi8(b));
+    _mm_storeu_si128((__m128i*)dst + 2, _mm512_cvtsepi32_epi8(c));
+    _mm_storeu_si128((__m128i*)dst + 3, _mm512_cvtsepi32_epi8(d));
+  }
+  #elif defined(VEC_IMPL_AVX)
+  /* pack 在 128 位 lane 内进行，结果的 32 位块顺序为 a0 b0 c0 d0 a1 b1 c1 d1，需重排 */
+  __m256i ab = _mm256_packs_epi32(a, b), cd = _mm256_packs_epi32(c, d);
+  __m256i r = u8 ? _mm256_packus_epi16(ab, cd) : _mm256_packs_epi16(ab, cd);
+  _mm256_storeu_si256((__m256i*)dst, _mm256_permutevar8x32_epi32(r, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)));
+  #elif defined(VEC_IMPL_SSE)
+  __m128i ab = _mm_packs_epi32(a, b), cd = _mm_packs_epi32(c, d);
+  _mm_storeu_si128((__m128i*)dst, u8 ? _mm_packus_epi16(ab, cd) : _mm_packs_epi16(ab, cd));
+  #elif defined(VEC_IMPL_NEON)
+  int16x8_t ab = vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)), cd = vcombine_s16(vqmovn_s32(c), vqmovn_s32(d));
+  if (u8) vst1q_u8((uint8_t*)dst, vcombine_u8(vqmovun_s16(ab), vqmovun_s16(cd)));
+  else vst1q_s8((int8_t*)dst, vcombine_s8(vqmovn_s16(ab), vqmovn_s16(cd)));
+  #endif
+}
+
+/* 4 * VEC_WIDTH 个字节符号 / 零扩展为 4 个 int32 向量 */
+VEC_FORCE_INLINE_ void vec_q8_unpack4_(const void* src, int u8, vint_t* out) {
+  #if defined(VEC_IMPL_AVX512)
+  int k;
+  for (k = 0; k < 4; ++k) {
+    __m128i x = _mm_loadu_si128((const __m128i*)src + k);
+    out[k] = u8 ? _mm512_cvtepu8_epi32(x) : _mm512_cvtepi8_epi32(x);
+  }
+  #elif defined(VEC_IMPL_AVX)
+  int k;
+  for (k = 0; k < 4; ++k) {
+    __m128i x = _mm_loadl_epi64((const __m128i*)((const char*)src + 8 * k));
+    out[k] = u8 ? _mm256_cvtepu8_epi32(x) : _mm256_cvtepi8_epi32(x);
+  }
+  #elif defined(VEC_IMPL_SSE)
+  /* 字节复制到 32 位 lane 的最高字节，再算术 / 逻辑右移 24 位（SSE2） */
+  __m128i x = _mm_loadu_si128((const __m128i*)src);
+  __m128i lo = _mm_unpacklo_epi8(x, x), hi = _mm_unpackhi_epi8(x, x);
+  out[0] = _mm_unpacklo_epi16(lo, lo);
+  out[1] = _mm_unpackhi_epi16(lo, lo);
+  out[2] = _mm_unpacklo_epi16(hi, hi);
+  out[3] = _mm_unpackhi_epi16(hi, hi);
+  if (u8) {
+    out[0] = _mm_srli_epi32(out[0], 24); out[1] = _mm_srli_epi32(out[1], 24);
+    out[2] = _mm_srli_epi32(out[2], 24); out[3] = _mm_srli_epi32(out[3], 24);
+  } else {
+    out[0] = _mm_srai_epi32(out[0], 24); out[1] = _mm_srai_epi32(out[1], 24);
+    out[2] = _mm_srai_epi32(out[2], 24); out[3] = _mm_srai_epi32(out[3], 24);
+  }
+  #elif defined(VEC_IMPL_NEON)
+  if (u8) {
+    uint8x16_t x = vld1q_u8((const uint8_t*)src);
+    uint16x8_t lo = vmovl_u8(vget_low_u8(x)), hi = vmovl_u8(vget_high_u8(x));
+    out[0] = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(lo)));
+    out[1] = vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(lo)));
+    out[2] = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(hi)));
+    out[3] = vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(hi)));
+  } else {
+    int8x16_t x = vld1q_s8((const int8_t*)src);
+    int16x8_t lo = vmovl_s8(vget_low_s8(x)), hi = vmovl_s8(vget_high_s8(x));
+    out[0] = vmovl_s16(vget_low_s16(lo));
+    out[1] = vmovl_s16(vget_high_s16(lo));
+    out[2] = vmovl_s16(vget_low_s16(hi));
+    out[3] = vmovl_s16(vget_high_s16(hi));
+  }
+  #endif
+}
+#endif
+
+/* 量化限幅：先把 x / scale 限制在 +-2^22 内，保证加上 zero_point 后不溢出 int32，最终范围由 pack 饱和决定 */
+#define VEC_Q8_LIMIT_ 4194304.0f
+
+/* 量化一段连续数据。inv_scale / zp 非 NULL 时为逐通道（下标与 src 相同，inv_scale 为 1 / scale），
+ * 否则使用 s / z */
+VEC_FORCE_INLINE_ void vec_quantize_run_(void* dst, const float* src, size_t n, const float* inv_scale,
+                                         const int32_t* zp, float s, int32_t z, int u8) {
+  const int32_t lo = u8 ? 0 : -128, hi = u8 ? 255 : 127;
+  const float inv = 1.0f / s;
+  unsigned char* out = (unsigned char*)dst;
+  size_t i = 0;
+#if VEC_WIDTH_F > 1
+  const vfloat32_t vinv = VEC_SET1_F(inv);
+  const vfloat32_t vlo = VEC_SET1_F(-VEC_Q8_LIMIT_), vhi = VEC_SET1_F(VEC_Q8_LIMIT_);
+  const vint_t vz = VEC_SET1_I(z);
+  for (; i + 4 * VEC_WIDTH_F <= n; i += 4 * VEC_WIDTH_F) {
+    vint_t q[4];
+    int k;
+    for (k = 0; k < 4; ++k) {
+      size_t o = i + (size_t)k * VEC_WIDTH_F;
+      vfloat32_t m = inv_scale ? VEC_LOADU_F(inv_scale + o) : vinv;
+      vfloat32_t y = VEC_MIN_F(VEC_MAX_F(VEC_MUL_F(VEC_LOADU_F(src + o), m), vlo), vhi);
+      q[k] = VEC_ADD_I(VEC_F2I_RN(y), zp ? VEC_LOADU_I(zp + o) : vz);
+    }
+    vec_q8_pack4_(out + i, q[0], q[1], q[2], q[3], u8);
+  }
+#endif
+  for (; i < n; ++i) {
+    float y = src[i] * (inv_scale ? inv_scale[i] : inv);
+    int32_t q;
+    y = y > VEC_Q8_LIMIT_ ? VEC_Q8_LIMIT_ : (y >= -VEC_Q8_LIMIT_ ? y : -VEC_Q8_LIMIT_);
+    q = (int32_t)lrintf(y) + (zp ? zp[i] : z);
+    q = q < lo ? lo : (q > hi ? hi : q);
+    out[i] = (unsigned char)(u8 ? (uint8_t)q : (uint8_t)(int8_t)q);
+  }
+}
+
+/* 逐通道量化：通道按 VEC_Q8_CBLOCK_ 分块，每块的 1 / scale 只算一次，在所有行间复用 */
+#define VEC_Q8_CBLOCK_ 512
+VEC_FORCE_INLINE_ void vec_quantize_per_channel_(void* dst, const float* src, size_t rows, size_t channels,
+                                                 const float* scale, const int32_t* zp, int u8) {
+  float inv[VEC_Q8_CBLOCK_];
+  size_t c0, c, r;
+  for (c0 = 0; c0 < channels; c0 += VEC_Q8_CBLOCK_) {
+    const size_t len = channels - c0 < VEC_Q8_CBLOCK_ ? channels - c0 : VEC_Q8_CBLOCK_;
+    for (c = 0; c < len; ++c) inv[c] = 1.0f / scale[c0 + c];
+    for (r = 0; r < rows; ++r)
+      vec_quantize_run_((unsigned char*)dst + r * channels + c0, src + r * channels + c0, len, inv,
+                        zp ? zp + c0 : NULL, 1.0f, 0, u8);
+  }
+}
+
+VEC_FORCE_INLINE_ void vec_dequantize_run_(float* dst, const void* src, size_t n, const float* scale,
+                                           const int32_t* zp, float s, int32_t z, int u8) {
+  size_t i = 0;
+#if VEC_WIDTH_F > 1
+  const vfloat32_t vs = VEC_SET1_F(s);
+  const vint_t vz = VEC_SET1_I(z);
+  for (; i + 4 * VEC_WIDTH_F <= n; i += 4 * VEC_WIDTH_F) {
+    vint_t q[4];
+    int k;
+    vec_q8_unpack4_((const unsigned char*)src + i, u8, q);
+    for (k = 0; k < 4; ++k) {
+      size_t o = i + (size_t)k * VEC_WIDTH_F;
+      vfloat32_t f = VEC_I2F(VEC_SUB_I(q[k], zp ? VEC_LOADU_I(zp + o) : vz));
+      VEC_STOREU_F(dst + o, VEC_MUL_F(f, scale ? VEC_LOADU_F(scale + o) : vs));
+    }
+  }
+#endif
+  for (; i < n; ++i) {
+    int32_t q = u8 ? (int32_t)((const uint8_t*)src)[i] : (int32_t)((const int8_t*)src)[i];
+    dst[i] = (float)(q - (zp ? zp[i] : z)) * (scale ? scale[i] : s);
+  }
+}
+
+static inline void vec_quantize_f32_to_i8(int8_t* dst, const float* src, size_t n, float scale, int32_t zero_point) {
+  VEC_PROF_BEGIN(vec_quantize_f32_to_i8);
+  vec_quantize_run_(dst, src, n, NULL, NULL, scale, zero_point, 0);
+  VEC_PROF_END(vec_quantize_f32_to_i8, n, n * (sizeof(float) + 1));
+}
+
+static inline void vec_quantize_f32_to_u8(uint8_t* dst, const float* src, size_t n, float scale, int32_t zero_point) {
+  VEC_PROF_BEGIN(vec_quantize_f32_to_u8);
+  vec_quantize_run_(dst, src, n, NULL, NULL, scale, zero_point, 1);
+  VEC_PROF_END(vec_quantize_f32_to_u8, n, n * (sizeof(float) + 1));
+}
+
+static inline void vec_quantize_f32_to_i8_per_channel(int8_t* dst, const float* src, size_t rows, size_t channels,
+                                                      const float* scale, const int32_t* zero_point) {
+  VEC_PROF_BEGIN(vec_quantize_f32_to_i8_per_channel);
+  vec_quantize_per_channel_(dst, src, rows, channels, scale, zero_point, 0);
+  VEC_PROF_END(vec_quantize_f32_to_i8_per_channel, rows * channels, rows * channels * (sizeof(float) + 1));
+}
+
+static inline void vec_quantize_f32_to_u8_per_channel(uint8_t* dst, const float* src, size_t rows, size_t channels,
+                                                      const float* scale, const int32_t* zero_point) {
+  VEC_PROF_BEGIN(vec_quantize_f32_to_u8_per_channel);
+  vec_quantize_per_channel_(dst, src, rows, channels, scale, zero_point, 1);
+  VEC_PROF_END(vec_quantize_f32_to_u8_per_channel, rows * channels, rows * channels * (sizeof(float) + 1));
+}
+
+static inline void vec_dequantize_i8_to_f32(float* dst, const int8_t* src, size_t n, float scale, int32_t zero_point) {
+  VEC_PROF_BEGIN(vec_dequantize_i8_to_f32);
+  vec_dequantize_run_(dst, src, n, NULL, NULL, scale, zero_point, 0);
+  VEC_PROF_END(vec_dequantize_i8_to_f32, n, n * (sizeof(float) + 1));
+}
+
+static inline void vec_dequantize_u8_to_f32(float* dst, const uint8_t* src, size_t n, float scale, int32_t zero_point) {
+  VEC_PROF_BEGIN(vec_dequantize_u8_to_f32);
+  vec_dequantize_run_(dst, src, n, NULL, NULL, scale, zero_point, 1);
+  VEC_PROF_END(vec_dequantize_u8_to_f32, n, n * (sizeof(float) + 1));
+}
+
+static inline void vec_dequantize_i8_to_f32_per_channel(float* dst, const int8_t* src, size_t rows, size_t channels,
+                                                        const float* scale, const int32_t* zero_point) {
+  size_t r;
+  VEC_PROF_BEGIN(vec_dequantize_i8_to_f32_per_channel);
+  for (r = 0; r < rows; ++r)
+    vec_dequantize_run_(dst + r * channels, src + r * channels, channels, scale, zero_point, 1.0f, 0, 0);
+  VEC_PROF_END(vec_dequantize_i8_to_f32_per_channel, rows * channels, rows * channels * (sizeof(float) + 1));
+}
+
+static inline void vec_dequantize_u8_to_f32_per_channel(float* dst, const uint8_t* src, size_t rows, size_t channels,
+                                                        const float* scale, const int32_t* zero_point) {
+  size_t r;
+  VEC_PROF_BEGIN(vec_dequantize_u8_to_f32_per_channel);
+  for (r = 0; r < rows; ++r)
+    vec_dequantize_run_(dst + r * channels, src + r * channels, channels, scale, zero_point, 1.0f, 0, 1);
+  VEC_PROF_END(vec_dequantize_u8_to_f32_per_channel, rows * channels, rows * channels * (sizeof(float) + 1));
+}
+
+#if defined(VEC_IMPL_AVX512) && defined(__AVX512BW__)
+/* 16 路 int32 求和；同 VEC_REDUCE_ADD_F，不用 _mm512_reduce_add_epi32 */
+static inline int32_t vec_reduce_add_epi32_512_(__m512i v) {
+  __m256i s = _mm256_add_epi32(VEC_LO256_I_(v), VEC_HI256_I_(v));
+  __m128i t = _mm_add_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+  t = _mm_add_epi32(t, _mm_shuffle_epi32(t, 0x4E));
+  t = _mm_add_epi32(t, _mm_shuffle_epi32(t, 0xB1));
+  return _mm_cvtsi128_si32(t);
+}
+#endif
+
+/* 把不足一块的尾部复制进补 0 的块缓冲区，各 SIMD 分支据此多做一次整块计算（补 0 的字节乘积为 0）。
+ * 点积不留 int8 x int8 标量尾循环：GCC 12 在 -O3 且开启 AVX-VNNI / AVX512-VNNI 时
+ * 会把它误向量化为 vpdpbusd（一侧按无符号解释），结果错误 */
+static inline void vec_dot8_pad_(unsigned char* ta, int8_t* tb, const unsigned char* a, const int8_t* b,
+                                 size_t len, size_t block) {
+  memset(ta, 0, block);
+  memset(tb, 0, block);
+  memcpy(ta, a, len);
+  memcpy(tb, b, len);
+}
+
+/* int8 点积。a_u8 非 0 时 a 按 uint8 解释；b 始终为 int8 */
+VEC_FORCE_INLINE_ int32_t vec_dot8_(const void* a, const int8_t* b, size_t n, int a_u8) {
+  const unsigned char* pa = (const unsigned char*)a;
+  int32_t sum = 0;
+  size_t i = 0;
+#if defined(VEC_IMPL_AVX512) && defined(__AVX512BW__) && defined(__AVX512VNNI__)
+  __m512i acc = _mm512_setzero_si512(), bsum = _mm512_setzero_si512();
+  const __m512i flip = _mm512_set1_epi8((char)0x80);
+  __m512i va, vb;
+  __mmask64 m = ~(__mmask64)0;
+  /* 最后一段（不足 64 字节）用掩码加载补 0，原因见 vec_dot8_pad_ */
+  for (; i < n; i += 64) {
+    if (n - i < 64) m = ((__mmask64)1 << (n - i)) - 1;
+    va = _mm512_maskz_loadu_epi8(m, pa + i);
+    vb = _mm512_maskz_loadu_epi8(m, b + i);
+    if (a_u8) {
+      acc = _mm512_dpbusd_epi32(acc, va, vb);
+    } else {
+      /* a * b = (a + 128) * b - 128 * b，a + 128 即按位翻转最高位后的无符号字节；
+       * sum(b + 128) 用 vpsadbw 累加到 64 位通道，比再做一次 vpdpbusd 便宜 */
+      acc = _mm512_dpbusd_epi32(acc, _mm512_xor_si512(va, flip), vb);
+      bsum = _mm512_add_epi64(bsum, _mm512_sad_epu8(_mm512_xor_si512(vb, flip), _mm512_setzero_si512()));
+    }
+  }
+  sum = vec_reduce_add_epi32_512_(acc);
+  if (!a_u8) {
+    /* 补 0 的字节同样计入了 128，循环结束时 i 即累加的字节总数 */
+    const uint32_t sb = (uint32_t)_mm512_reduce_add_epi64(bsum) - 128u * (uint32_t)i;
+    sum = (int32_t)((uint32_t)sum - 128u * sb);
+  }
+#elif defined(VEC_IMPL_AVX512) && defined(__AVX512BW__)
+  __m512i acc = _mm512_setzero_si512();
+  unsigned char ta[32];
+  int8_t tb[32];
+  for (; i < n; i += 32) {
+    const unsigned char* xa = pa + i;
+    const int8_t* xb = b + i;
+    __m256i va, vb;
+    __m512i wa;
+    if (n - i < 32) {
+      vec_dot8_pad_(ta, tb, xa, xb, n - i, 32);
+      xa = ta;
+      xb = tb;
+    }
+    va = _mm256_loadu_si256((const __m256i*)xa);
+    vb = _mm256_loadu_si256((const __m256i*)xb);
+    wa = a_u8 ? _mm512_cvtepu8_epi16(va) : _mm512_cvtepi8_epi16(va);
+    acc = _mm512_add_epi32(acc, _mm512_madd_epi16(wa, _mm512_cvtepi8_epi16(vb)));
+  }
+  sum = vec_reduce_add_epi32_512_(acc);
+#elif defined(__AVX2__)
+  __m256i acc = _mm256_setzero_si256();
+  unsigned char ta[16];
+  int8_t tb[16];
+  int32_t t[8];
+  int k;
+  for (; i < n; i += 16) {
+    const unsigned char* xa = pa + i;
+    const int8_t* xb = b + i;
+    __m128i va, vb;
+    __m256i wa;
+    if (n - i < 16) {
+      vec_dot8_pad_(ta, tb, xa, xb, n - i, 16);
+      xa = ta;
+      xb = tb;
+    }
+    va = _mm_loadu_si128((const __m128i*)xa);
+    vb = _mm_loadu_si128((const __m128i*)xb);
+    wa = a_u8 ? _mm256_cvtepu8_epi16(va) : _mm256_cvtepi8_epi16(va);
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(wa, _mm256_cvtepi8_epi16(vb)));
+  }
+  _mm256_storeu_si256((__m256i*)t, acc);
+  for (k = 0; k < 8; ++k) sum += t[k];
+#elif (defined(VEC_IMPL_SSE) || defined(VEC_IMPL_AVX)) && defined(__SSE2__)
+  __m128i acc = _mm_setzero_si128();
+  const __m128i z = _mm_setzero_si128();
+  unsigned char ta[16];
+  int8_t tb[16];
+  int32_t t[4];
+  for (; i < n; i += 16) {
+    const unsigned char* xa = pa + i;
+    const int8_t* xb = b + i;
+    __m128i va, vb, alo, ahi;
+    if (n - i < 16) {
+      vec_dot8_pad_(ta, tb, xa, xb, n - i, 16);
+      xa = ta;
+      xb = tb;
+    }
+    va = _mm_loadu_si128((const __m128i*)xa);
+    vb = _mm_loadu_si128((const __m128i*)xb);
+    alo = a_u8 ? _mm_unpacklo_epi8(va, z) : _mm_srai_epi16(_mm_unpacklo_epi8(va, va), 8);
+    ahi = a_u8 ? _mm_unpackhi_epi8(va, z) : _mm_srai_epi16(_mm_unpackhi_epi8(va, va), 8);
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(alo, _mm_srai_epi16(_mm_unpacklo_epi8(vb, vb), 8)));
+    acc = _mm_add_epi32(acc, _mm_madd_epi16(ahi, _mm_srai_epi16(_mm_unpackhi_epi8(vb, vb), 8)));
+  }
+  _mm_storeu_si128((__m128i*)t, acc);
+  sum = t[0] + t[1] + t[2] + t[3];
+#elif defined(VEC_IMPL_NEON)
+  int32x4_t acc = vdupq_n_s32(0);
+  unsigned char ta[16];
+  int8_t tb[16];
+  for (; i < n; i += 16) {
+    const unsigned char* xa = pa + i;
+    const int8_t* xb = b + i;
+    int8x16_t vb;
+    if (n - i < 16) {
+      vec_dot8_pad_(ta, tb, xa, xb, n - i, 16);
+      xa = ta;
+      xb = tb;
+    }
+    vb = vld1q_s8(xb);
+    if (a_u8) {
+  #if defined(__ARM_FEATURE_MATMUL_INT8)
+      acc = vusdotq_s32(acc, vld1q_u8(xa), vb);
+  #else
+      uint8x16_t va = vld1q_u8(xa);
+      int16x8_t alo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(va)));
+      int16x8_t ahi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(va)));
+      int16x8_t blo = vmovl_s8(vget_low_s8(vb)), bhi = vmovl_s8(vget_high_s8(vb));
+      acc = vmlal_s16(acc, vget_low_s16(alo), vget_low_s16(blo));
+      acc = vmlal_s16(acc, vget_high_s16(alo), vget_high_s16(blo));
+      acc = vmlal_s16(acc, vget_low_s16(ahi), vget_low_s16(bhi));
+      acc = vmlal_s16(acc, vget_high_s16(ahi), vget_high_s16(bhi));
+  #endif
+    } else {
+      int8x16_t va = vld1q_s8((const int8_t*)xa);
+  #if defined(__ARM_FEATURE_DOTPROD)
+      acc = vdotq_s32(acc, va, vb);
+  #else
+      /* int8 乘积不超过 2^14，int16 中精确；两两累加到 int32 */
+      acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+      acc = vpadalq_s16(acc, vmull_s8(vget_high_s8(va), vget_high_s8(vb)));
+  #endif
+    }
+  }
+  {
+    int32x2_t s2 = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+    sum = vget_lane_s32(vpadd_s32(s2, s2), 0);
+  }
+#else
+  for (; i < n; ++i) sum += (a_u8 ? (int32_t)pa[i] : (int32_t)(int8_t)pa[i]) * (int32_t)b[i];
+#endif
+  return sum;
+}
+
+static inline int32_t vec_dot_i8(const int8_t* a, const int8_t* b, size_t n) {
+  int32_t r;
+  VEC_PROF_BEGIN(vec_dot_i8);
+  r = vec_dot8_(a, b, n, 0);
+  VEC_PROF_END(vec_dot_i8, n, 2 * n);
+  return r;
+}
+
+static inline int32_t vec_dot_u8i8(const uint8_t* a, const int8_t* b, size_t n) {
+  int32_t r;
+  VEC_PROF_BEGIN(vec_dot_u8i8);
+  r = vec_dot8_(a, b, n, 1);
+  VEC_PROF_END(vec_dot_u8i8, n, 2 * n);
+  return r;
+}
+
+/* ---------- 流式处理：mmap / 后台线程 pread 双缓冲（需定义 VEC_ENABLE_STREAM） ---------- */
+/*
+ * 用于处理放不进内存的大型原始数组文件（float32 / int32 等定长元素，无文件头）。
+ * 仅在 POSIX 平台可用，且需要链接 pthread（`-pthread`）。用法：
+ *
+ *   #define VEC_ENABLE_STREAM
+ *   #include "vectorize.h"
+ *
+ *   int vec_stream_file(path, elem_size, chunk_elems, flags, fn, user)
+ *     - path        : 文件路径
+ *     - elem_size   : 单个元素字节数（float / int 为 4）
+ *     - chunk_elems : 每块元素数，会向上取整到 VEC_STREAM_ALIGN（64）的倍数，因而也是 VEC_WIDTH 的倍数；
+ *                     传 0 使用 VEC_STREAM_DEFAULT_CHUNK
+ *     - flags       : VEC_STREAM_* 的组合
+ *     - fn          : 用户内核 fn(block, n, first, user)，block 指向本块首元素，
+ *                     n 为本块元素数（仅最后一块可能不是 VEC_WIDTH 的倍数），first 为本块首元素在文件中的下标
+ *     - user        : 透传给 fn 的用户指针
+ *   返回 0 表示成功；失败返回 -1，并保留 errno。
+ *
+ * 两种模式：
+ *   - VEC_STREAM_MMAP   : 整个文件映射进地址空间，按块交给 fn；处理当前块前对下一块 MADV_WILLNEED 预读，
+ *                         处理完后 MADV_DONTNEED 释放，驻留内存约为两块大小。配合 VEC_STREAM_WRITE 时
+ *                         使用 MAP_SHARED，fn 对 block 的修改即零拷贝写回文件。
+ *   - 默认（pread）     : 后台线程把下一块 pread 进另一个对齐缓冲区，与 fn 的计算重叠；
+ *                         配合 VEC_STREAM_WRITE 时由后台线程 pwrite 写回已处理的块。峰值内存为两块缓冲区。
+ * 两种模式下 block 指针都按 VEC_STREAM_ALIGN 字节对齐，可以直接使用 VEC_LOAD_F / VEC_STORE_F。
+ *
+ * 内置内核：vec_stream_kernel_sum_f32（user 为 double* 累加器）、vec_stream_kernel_scale_f32（user 为 const float* 系数，
+ * 需配合 VEC_STREAM_WRITE）。
+ */
+#if defined(VEC_ENABLE_STREAM)
+
+#if !(defined(__unix__) || defined(__APPLE__))
+  #error "VEC_ENABLE_STREAM requires a POSIX platform (mmap / pread / pthread)."
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define VEC_STREAM_MMAP      0x1  /* 使用 mmap，否则使用后台线程 + pread 双缓冲 */
+#define VEC_STREAM_WRITE     0x2  /* 把 fn 对 block 的修改写回文件 */
+#define VEC_STREAM_HUGEPAGE  0x4  /* mmap 模式下额外 madvise(MADV_HUGEPAGE)，内核不支持时忽略 */
+
+#ifndef VEC_STREAM_DEFAULT_CHUNK
+  #define VEC_STREAM_DEFAULT_CHUNK (1u << 20)  /* 元素数：float32 下为 4 MiB */
+#endif
+#define VEC_STREAM_ALIGN 64
+
+typedef void (*vec_stream_fn)(void* block, size_t n, size_t first, void* user);
+
+static inline void vec_stream_kernel_sum_f32(void* block, size_t n, size_t first, void* user) {
+  /* 按 4096 个元素分段求和后再累加到 double，避免整块 float 累加的精度损失 */
+  const float* p = (const float*)block;
+  double acc = 0.0;
+  size_t i;
+  (void)first;
+  for (i = 0; i < n; i += 4096)
+    acc += (double)vec_sum_f32(p + i, (n - i < 4096) ? n - i : 4096);
+  *(double*)user += acc;
+}
+
+static inline void vec_stream_kernel_scale_f32(void* block, size_t n, size_t first, void* user) {
+  (void)first;
+  vec_scale_f32((float*)block, (const float*)block, n, *(const float*)user);
+}
+
+static inline int vec_stream_mmap_(int fd, size_t nelem, size_t elem_size, size_t chunk,
+                                   int flags, vec_stream_fn fn, void* user) {
+  size_t bytes = nelem * elem_size;
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  int prot = PROT_READ | ((flags & VEC_STREAM_WRITE) ? PROT_WRITE : 0);
+  int share = (flags & VEC_STREAM_WRITE) ? MAP_SHARED : MAP_PRIVATE;
+  unsigned char* base = (unsigned char*)mmap(NULL, bytes, prot, share, fd, 0);
+  size_t first;
+  if (base == (unsigned char*)MAP_FAILED) return -1;
+
+  madvise(base, bytes, MADV_SEQUENTIAL);
+#if defined(MADV_HUGEPAGE)
+  if (flags & VEC_STREAM_HUGEPAGE) madvise(base, bytes, MADV_HUGEPAGE);
+#endif
+
+  for (first = 0; first < nelem; first += chunk) {
+    size_t n = (nelem - first < chunk) ? nelem - first : chunk;
+    size_t off = first * elem_size;
+    size_t next = off + n * elem_size;
+    /* 预读下一块，让缺页 I/O 与本块计算重叠 */
+    if (next < bytes) {
+      size_t len = (bytes - next < chunk * elem_size) ? bytes - next : chunk * elem_size;
+      size_t lo = next & ~(page - 1);
+      madvise(base + lo, len + (next - lo), MADV_WILLNEED);
+    }
+    fn(base + off, n, first, user);
+    /* 释放已处理的整页（MAP_SHARED 下脏页仍保留在页缓存中，由内核回写） */
+    {
+      size_t lo = off & ~(page - 1);
+      size_t hi = next & ~(page - 1);
+      if (hi > lo) madvise(base + lo, hi - lo, MADV_DONTNEED);
+    }
+  }
+
+  if ((flags & VEC_STREAM_WRITE) && msync(base, bytes, MS_SYNC) != 0) {
+    int e = errno;
+    munmap(base, bytes);
+    errno = e;
+    return -1;
+  }
+  return munmap(base, bytes);
+}
+
+/* pread 模式：两个缓冲槽在 I/O 线程与计算线程之间轮转 */
+enum { VEC_STREAM_SLOT_FREE = 0, VEC_STREAM_SLOT_FILLED, VEC_STREAM_SLOT_DONE };
+
+typedef struct {
+  int fd;
+  int write_back;
+  size_t nelem, elem_size, chunk, nchunks;
+  void* buf[2];
+  int state[2];
+  size_t index[2];
+  int err;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+} vec_stream_ctx_;
+
+static inline int vec_stream_pio_(int fd, void* buf, size_t len, off_t off, int writing) {
+  unsigned char* p = (unsigned char*)buf;
+  while (len > 0) {
+    ssize_t r = writing ? pwrite(fd, p, len, off) : pread(fd, p, len, off);
+    if (r < 0) {
+      if (errno == EINTR) continue;
+      return errno;
+    }
+    if (r == 0) return EIO;  /* 文件在处理过程中被截断 */
+    p += r; len -= (size_t)r; off += r;
+  }
+  return 0;
+}
+
+/* 把槽 s 中已处理的块写回；调用前持有锁，I/O 期间释放 */
+static inline int vec_stream_flush_slot_(vec_stream_ctx_* c, int s) {
+  size_t k = c->index[s];
+  size_t n = (c->nelem - k * c->chunk < c->chunk) ? c->nelem - k * c->chunk : c->chunk;
+  int e;
+  pthread_mutex_unlock(&c->lock);
+  e = vec_stream_pio_(c->fd, c->buf[s], n * c->elem_size, (off_t)(k * c->chunk * c->elem_size), 1);
+  pthread_mutex_lock(&c->lock);
+  c->state[s] = VEC_STREAM_SLOT_FREE;
+  return e;
+}
+
+static inline void* vec_stream_io_thread_(void* arg) {
+  vec_stream_ctx_* c = (vec_stream_ctx_*)arg;
+  size_t k;
+  int s, e = 0;
+  pthread_mutex_lock(&c->lock);
+  for (k = 0; k < c->nchunks && !c->err; ++k) {
+    size_t n = (c->nelem - k * c->chunk < c->chunk) ? c->nelem - k * c->chunk : c->chunk;
+    s = (int)(k & 1);
+    while (c->state[s] == VEC_STREAM_SLOT_FILLED && !c->err) pthread_cond_wait(&c->cond, &c->lock);
+    if (c->err) break;
+    if (c->state[s] == VEC_STREAM_SLOT_DONE && (e = vec_stream_flush_slot_(c, s)) != 0) break;
+    pthread_mutex_unlock(&c->lock);
+    e = vec_stream_pio_(c->fd, c->buf[s], n * c->elem_size, (off_t)(k * c->chunk * c->elem_size), 0);
+    pthread_mutex_lock(&c->lock);
+    if (e) break;
+    c->index[s] = k;
+    c->state[s] = VEC_STREAM_SLOT_FILLED;
+    pthread_cond_broadcast(&c->cond);
+  }
+  /* 写回最后（至多）两块 */
+  for (s = 0; s < 2 && !e && !c->err; ++s) {
+    int t = (int)((k + (size_t)s) & 1);
+    while (c->state[t] == VEC_STREAM_SLOT_FILLED && !c->err) pthread_cond_wait(&c->cond, &c->lock);
+    if (c->state[t] == VEC_STREAM_SLOT_DONE) e = vec_stream_flush_slot_(c, t);
+  }
+  if (e && !c->err) c->err = e;
+  pthread_cond_broadcast(&c->cond);
+  pthread_mutex_unlock(&c->lock);
+  return NULL;
+}
+
+static inline int vec_stream_pread_(int fd, size_t nelem, size_t elem_size, size_t chunk,
+                                    int flags, vec_stream_fn fn, void* user) {
+  vec_stream_ctx_ c;
+  pthread_t io;
+  size_t k;
+  int e;
+
+  c.fd = fd;
+  c.write_back = (flags & VEC_STREAM_WRITE) != 0;
+  c.nelem = nelem;
+  c.elem_size = elem_size;
+  c.chunk = chunk;
+  c.nchunks = (nelem + chunk - 1) / chunk;
+  c.state[0] = c.state[1] = VEC_STREAM_SLOT_FREE;
+  c.index[0] = c.index[1] = 0;
+  c.err = 0;
+  c.buf[0] = c.buf[1] = NULL;
+  if (posix_memalign(&c.buf[0], VEC_STREAM_ALIGN, chunk * elem_size) != 0 ||
+      posix_memalign(&c.buf[1], VEC_STREAM_ALIGN, chunk * elem_size) != 0) {
+    free(c.buf[0]);
+    errno = ENOMEM;
+    return -1;
+  }
+  pthread_mutex_init(&c.lock, NULL);
+  pthread_cond_init(&c.cond, NULL);
+  if ((e = pthread_create(&io, NULL, vec_stream_io_thread_, &c)) != 0) {
+    c.err = e;
+    goto done;
+  }
+
+  pthread_mutex_lock(&c.lock);
+  for (k = 0; k < c.nchunks; ++k) {
+    int s = (int)(k & 1);
+    size_t n = (nelem - k * chunk < chunk) ? nelem - k * chunk : chunk;
+    while (c.state[s] != VEC_STREAM_SLOT_FILLED && !c.err) pthread_cond_wait(&c.cond, &c.lock);
+    if (c.err) break;
+    pthread_mutex_unlock(&c.lock);
+    fn(c.buf[s], n, k * chunk, user);
+    pthread_mutex_lock(&c.lock);
+    c.state[s] = c.write_back ? VEC_STREAM_SLOT_DONE : VEC_STREAM_SLOT_FREE;
+    pthread_cond_broadcast(&c.cond);
+  }
+  pthread_mutex_unlock(&c.lock);
+  pthread_join(io, NULL);
+
+done:
+  pthread_cond_destroy(&c.cond);
+  pthread_mutex_destroy(&c.lock);
+  free(c.buf[0]);
+  free(c.buf[1]);
+  if (c.err) {
+    errno = c.err;
+    return -1;
+  }
+  return 0;
+}
+
+static inline int vec_stream_file(const char* path, size_t elem_size, size_t chunk_elems,
+                                  int flags, vec_stream_fn fn, void* user) {
+  struct stat st;
+  size_t nelem;
+  int fd, ret, e;
+
+  if (elem_size == 0 || fn == NULL) {
+    errno = EINVAL;
+    return -1;
+  }
+  if (chunk_elems == 0) chunk_elems = VEC_STREAM_DEFAULT_CHUNK;
+  chunk_elems = (chunk_elems + VEC_STREAM_ALIGN - 1) / VEC_STREAM_ALIGN * VEC_STREAM_ALIGN;
+
+  fd = open(path, (flags & VEC_STREAM_WRITE) ? O_RDWR : O_RDONLY);
+  if (fd < 0) return -1;
+  if (fstat(fd, &st) != 0) {
+    e = errno;
+    close(fd);
+    errno = e;
+    return -1;
+  }
+  nelem = (size_t)st.st_size / elem_size;  /* 忽略末尾不足一个元素的字节 */
+  if (nelem == 0) {
+    close(fd);
+    return 0;
+  }
+
+  if (flags & VEC_STREAM_MMAP) {
+    ret = vec_stream_mmap_(fd, nelem, elem_size, chunk_elems, flags, fn, user);
+  } else {
+#if defined(POSIX_FADV_SEQUENTIAL)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    ret = vec_stream_pread_(fd, nelem, elem_size, chunk_elems, flags, fn, user);
+  }
+  e = errno;
+  close(fd);
+  errno = e;
+  return ret;
+}
+
+#endif /* VEC_ENABLE_STREAM */
+
 /* ---------- 结束 ---------- */
+#if defined(__GNUC__) && !defined(__clang__)
+  #pragma GCC diagnostic pop
+#endif
 #endif /* VECTORIZE_HEADER_H */